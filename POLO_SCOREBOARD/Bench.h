@@ -0,0 +1,270 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include <TFT_eSPI.h>
+#include "FrameDecoder.h"
+#include "StateJson.h"
+#include "StatePipeline.h"
+#include "StatePacket.h"
+#include "SerialHandler.h"
+
+extern TFT_eSPI tft;
+extern void displayScoreData();
+extern void displayWebsiteURL();
+extern void displayConfigPortal();
+extern bool displayingWebsiteURL;
+extern bool inConfigPortalMode;
+
+// On-device microbenchmarks for the hot paths, run from the loop task when /bench?run=1
+// is requested. Reports CPU cycles per operation and the heap an operation's result holds.
+// The same decode and JSON cases run on Linux under Google Benchmark (POLO_SCOREBOARD_LINUX).
+
+// A console frame as it arrives on the UART: STX, channel 1, T2, 12:00.99, 01 - 03, ETX
+static const char BENCH_FRAME[] = "\x02" "1T2120099" "0103" "\x03";
+static const int BENCH_FRAME_LENGTH = sizeof(BENCH_FRAME) - 1;
+
+struct BenchCase {
+    const char* name;
+    uint16_t iterations;
+    void (*run)();
+};
+
+// Results are kept here so the work can't be optimized away, and so heap use can be measured
+ScoreFrame benchFrame;
+ScoreFrame benchPrevious;
+volatile bool benchFlag = false;
+char benchBuffer[STATE_JSON_CAPACITY];
+char benchBuffer2[64];
+uint8_t benchPacket[STATE_PACKET_SIZE];
+String benchString;
+String benchString2;
+
+void benchFrameDecode() {
+    decodeScoreFrame(BENCH_FRAME, BENCH_FRAME_LENGTH, benchFrame);
+}
+
+void benchFrameValidate() {
+    benchFlag = isScoreFrameValid(benchFrame);
+}
+
+void benchFrameChanged() {
+    benchFlag = hasScoreFrameChanged(benchFrame, benchPrevious, true);
+}
+
+// The hex/ASCII dump parseMessageFormat builds for the debug page
+void benchFrameDump() {
+    formatRawFrame(BENCH_FRAME, BENCH_FRAME_LENGTH, benchBuffer, sizeof(benchBuffer), benchBuffer2, sizeof(benchBuffer2));
+}
+
+// The ArduinoJson document SerialHandler built for the state message before formatStateJson
+void benchJsonArduinoJson() {
+    StaticJsonDocument<256> doc;
+    doc["time"] = benchFrame.timeFormatted;
+    doc["home"] = benchFrame.homeScore;
+    doc["away"] = benchFrame.awayScore;
+    doc["deviceType"] = String(benchFrame.deviceType) + String(benchFrame.deviceNumber);
+    doc["channel"] = benchFrame.channel;
+    doc["isRunning"] = (benchFrame.deviceType == 'T');
+    doc["tenths"] = String(benchFrame.subSecond[0]);
+    doc["seq"] = 1234;
+    doc["ts"] = 123456789UL;
+    doc["bt"] = 123459876UL;
+    doc["source"] = "scoreboard";
+    benchString = "";
+    serializeJson(doc, benchString);
+}
+
+void benchJsonSnprintf() {
+    StateJsonFields fields;
+    fields.sequence = 1234;
+    fields.arrivalUs = 123456789UL;
+    fields.sentUs = 123459876UL;
+    formatStateJson(benchBuffer, sizeof(benchBuffer), benchFrame, fields);
+}
+
+// Keeps what the pipeline hands over instead of sending it, with every slot due
+struct BenchPipelineOutput : StatePipelineOutput {
+    void stateChanged(const StatePipelineState& state, uint32_t arrivalUs) override {}
+
+    void gameEvent(GameEvent& event) override {
+        formatGameEventJson(benchBuffer2, sizeof(benchBuffer2), event, micros());
+    }
+
+    bool isBroadcastDue(bool& newState) override {
+        newState = true;
+        return true;
+    }
+
+    void describeState(StateJsonFields& fields, StatePacket& packet) override {
+        fields.arrivalUs = micros();
+        fields.sentUs = micros();
+    }
+
+    void sendState(const char* json, size_t length, const StatePacket& packet, bool newState) override {
+        memcpy(benchBuffer, json, length + 1);
+        encodeStatePacket(packet, benchPacket, sizeof(benchPacket));
+    }
+};
+
+StatePipelineState benchPipeline;
+BenchPipelineOutput benchPipelineOutput;
+
+// Everything a changed frame goes through before the sockets and the TFT: decode and validate,
+// then runStatePipeline() as SerialHandler calls it, and the screen's status line
+void benchFramePipeline() {
+    ScoreFrame frame = benchPipeline.current;
+    decodeScoreFrame(BENCH_FRAME, BENCH_FRAME_LENGTH, frame);
+    if (!isScoreFrameValid(frame)) return;
+    benchPipeline.previous = benchPrevious; // Every run is a change
+    benchFlag = runStatePipeline(benchPipeline, frame, micros(), true, benchPipelineOutput);
+
+    snprintf(benchBuffer2, sizeof(benchBuffer2), "Device: %c  Channel: %d", frame.deviceType, frame.channel);
+}
+
+// The status line at the bottom of the scoreboard screen
+void benchStatusString() {
+    benchString = "Device: " + String(benchFrame.deviceType) +
+                  "  Channel: " + String(benchFrame.channel);
+}
+
+void benchStatusSnprintf() {
+    snprintf(benchBuffer, sizeof(benchBuffer), "Device: %c  Channel: %d",
+             benchFrame.deviceType, benchFrame.channel);
+}
+
+void benchTftDrawTime() {
+    tft.setTextDatum(TC_DATUM);
+    tft.setTextColor(TFT_YELLOW, TFT_BLACK);
+    tft.setTextSize(3);
+    tft.drawString(benchFrame.timeFormatted, tft.width()/2, 25);
+}
+
+void benchTftRenderScreen() {
+    displayScoreData();
+}
+
+static const BenchCase BENCH_CASES[] = {
+    {"frame_decode",          1000, benchFrameDecode},
+    {"frame_validate",        1000, benchFrameValidate},
+    {"frame_changed",         1000, benchFrameChanged},
+    {"frame_dump",             100, benchFrameDump},
+    {"json_arduinojson",       100, benchJsonArduinoJson},
+    {"json_snprintf",          100, benchJsonSnprintf},
+    {"status_string_concat",   100, benchStatusString},
+    {"status_snprintf",        100, benchStatusSnprintf},
+    {"frame_pipeline",         100, benchFramePipeline},
+    {"tft_draw_time",           20, benchTftDrawTime},
+    {"tft_render_screen",        5, benchTftRenderScreen}
+};
+
+class BenchRunner {
+private:
+    volatile bool requested = false;
+    String results;
+    SemaphoreHandle_t resultsLock = nullptr; // The route reads results from the async_tcp task
+
+    void runCase(const BenchCase& benchCase, JsonObject entry) {
+        // Warm up caches and let String buffers reach their working size
+        benchCase.run();
+
+        uint32_t freeBefore = ESP.getFreeHeap();
+        uint32_t start = ESP.getCycleCount();
+        for (uint16_t i = 0; i < benchCase.iterations; i++) {
+            benchCase.run();
+        }
+        uint32_t cycles = ESP.getCycleCount() - start;
+        uint32_t freeAfter = ESP.getFreeHeap();
+
+        // Heap held by one operation's result, measured from empty sinks
+        benchString = String();
+        benchString2 = String();
+        uint32_t freeEmpty = ESP.getFreeHeap();
+        benchCase.run();
+        int32_t heapPerOp = (int32_t)freeEmpty - (int32_t)ESP.getFreeHeap();
+
+        uint32_t cyclesPerOp = cycles / benchCase.iterations;
+        entry["name"] = benchCase.name;
+        entry["iterations"] = benchCase.iterations;
+        entry["cyclesPerOp"] = cyclesPerOp;
+        entry["usPerOp"] = (float)cyclesPerOp / getCpuFrequencyMhz();
+        entry["heapPerOp"] = heapPerOp;                               // Held by the result
+        entry["heapDelta"] = (int32_t)freeBefore - (int32_t)freeAfter; // Not given back across the run
+    }
+
+public:
+    BenchRunner() {}
+
+    void begin() {
+        resultsLock = xSemaphoreCreateMutex();
+    }
+
+    // Called from the /bench route, the run itself happens on the loop task
+    void request() {
+        requested = true;
+    }
+
+    bool isRequested() const { return requested; }
+
+    String getResults() {
+        String copy;
+        if (resultsLock != nullptr && xSemaphoreTake(resultsLock, pdMS_TO_TICKS(100)) == pdTRUE) {
+            copy = results;
+            xSemaphoreGive(resultsLock);
+        }
+        return copy;
+    }
+
+    // Call from loop(). Blocks for the length of the run, well under a second.
+    void update() {
+        if (!requested) return;
+        requested = false;
+
+        decodeScoreFrame(BENCH_FRAME, BENCH_FRAME_LENGTH, benchFrame);
+
+        // The render cases draw over the screen, so note which one to put back
+        bool portalScreen = inConfigPortalMode;
+        bool urlScreen = displayingWebsiteURL;
+
+        DynamicJsonDocument doc(3072);
+        doc["cpuMhz"] = getCpuFrequencyMhz();
+        doc["freeHeap"] = ESP.getFreeHeap();
+        doc["minFreeHeap"] = ESP.getMinFreeHeap();
+        doc["maxAllocHeap"] = ESP.getMaxAllocHeap(); // Largest free block, shrinks as the heap fragments
+        JsonArray cases = doc.createNestedArray("cases");
+        for (size_t i = 0; i < sizeof(BENCH_CASES) / sizeof(BENCH_CASES[0]); i++) {
+            runCase(BENCH_CASES[i], cases.createNestedObject());
+        }
+
+        benchString = String();
+        benchString2 = String();
+        String output;
+        serializeJson(doc, output);
+        if (resultsLock != nullptr && xSemaphoreTake(resultsLock, portMAX_DELAY) == pdTRUE) {
+            results = output;
+            xSemaphoreGive(resultsLock);
+        }
+
+        if (portalScreen) {
+            displayConfigPortal();
+        } else if (urlScreen) {
+            displayWebsiteURL();
+        } else {
+            displayScoreData();
+        }
+    }
+};
+
+extern BenchRunner benchRunner;
+
+// Used by the /bench route in WebRoutes.h
+void requestBenchRun() {
+    benchRunner.request();
+}
+
+String getBenchResults() {
+    return benchRunner.getResults();
+}
+
+#endif // BENCH_H
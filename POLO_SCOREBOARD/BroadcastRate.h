@@ -0,0 +1,78 @@
+#ifndef BROADCAST_RATE_H
+#define BROADCAST_RATE_H
+
+#include <Arduino.h>
+#include "Parameters.h"
+
+// Game phases used to pick how often state is broadcast
+enum GamePhase {
+    PHASE_STOPPAGE,     // Clock stopped - send on change plus a slow heartbeat
+    PHASE_PLAY,         // Clock running - once per second
+    PHASE_FINAL_MINUTE  // Clock running in the last minute - tenths at up to 10 Hz
+};
+
+class BroadcastRateController {
+private:
+    // Configuration, the heartbeat interval is PARAM_HEARTBEAT
+    static const unsigned long PLAY_INTERVAL = 1000;         // 1 Hz during normal play
+    static const unsigned long FINAL_MINUTE_INTERVAL = 100;  // 10 Hz in the final minute
+
+    GamePhase phase = PHASE_STOPPAGE;
+    unsigned long lastSendTime = 0;
+    bool pending = false;   // A change is waiting for its slot
+    bool urgent = false;    // A change that must not wait (score, clock start/stop)
+    bool forced = false;    // Send on the next pass even without a change (catch-up)
+
+public:
+    static GamePhase phaseFor(bool running, const char* timeFormatted) {
+        if (!running) return PHASE_STOPPAGE;
+        // Countdown clock: "00:ss" is the last minute of the chukker
+        if (timeFormatted[0] == '0' && timeFormatted[1] == '0') return PHASE_FINAL_MINUTE;
+        return PHASE_PLAY;
+    }
+
+    GamePhase getPhase() const { return phase; }
+
+    // Record a state change. Phase changes and score changes go out immediately.
+    void markChanged(GamePhase newPhase, bool scoreChanged) {
+        if (newPhase != phase) {
+            phase = newPhase;
+            urgent = true;
+        }
+        if (scoreChanged) urgent = true;
+        pending = true;
+    }
+
+    // True when a broadcast is due at currentMillis
+    bool isDue(unsigned long currentMillis) const {
+        unsigned long elapsed = currentMillis - lastSendTime;
+        if (forced) return true;
+        if (pending) {
+            if (urgent) return true;
+            if (phase == PHASE_FINAL_MINUTE) return elapsed >= FINAL_MINUTE_INTERVAL;
+            if (phase == PHASE_PLAY) return elapsed >= PLAY_INTERVAL;
+            return true; // Stoppage: every change goes out, changes are rare
+        }
+        return elapsed >= parameters.get(PARAM_HEARTBEAT);
+    }
+
+    void markSent(unsigned long currentMillis) {
+        lastSendTime = currentMillis;
+        pending = false;
+        urgent = false;
+        forced = false;
+    }
+
+    // Send at the next opportunity regardless of the phase rate
+    void forceNext() {
+        forced = true;
+    }
+
+    bool isPending() const { return pending; }
+    bool isForced() const { return forced; }
+
+    // Sub-second digits only matter to viewers in the final minute
+    bool tracksTenths() const { return phase == PHASE_FINAL_MINUTE; }
+};
+
+#endif // BROADCAST_RATE_H
@@ -2,6 +2,7 @@
 #define BUTTON_HANDLER_H
 
 #include <Arduino.h>
+#include "LoopWake.h"
 
 // T-Display S3 button pins
 #define BUTTON_1 0    // Boot button (GPIO0)
@@ -17,26 +18,49 @@ enum ButtonPressType {
 // Callback function type
 typedef void (*ButtonCallback)(uint8_t button, ButtonPressType type);
 
+// Edge timestamps recorded by the pin interrupts.
+// A burst of bounces is kept as its first and last edge.
+struct ButtonEdges {
+    volatile unsigned long firstEdge;
+    volatile unsigned long lastEdge;
+    volatile bool pending;
+};
+
 class ButtonHandler {
 private:
+    static ButtonEdges edges[2];
+    static portMUX_TYPE edgeMux;
+
     // Button state variables
-    bool lastButtonState[2] = {HIGH, HIGH}; // Buttons are typically pulled-up
-    bool buttonState[2] = {HIGH, HIGH};
-    unsigned long lastDebounceTime[2] = {0, 0};
+    bool buttonState[2] = {false, false};  // Debounced, true = pressed
     unsigned long buttonPressStartTime[2] = {0, 0};
     bool buttonPressed[2] = {false, false};
     
     // Very long press tracking
-    bool veryLongPressActive[2] = {false, false};
     bool veryLongPressTriggered[2] = {false, false};
     
     // Configuration
-    static const unsigned long DEBOUNCE_DELAY = 50;        // Debounce time in ms
+    static const unsigned long DEBOUNCE_DELAY = 50;        // Quiet time after the last edge in ms
     static const unsigned long LONG_PRESS_TIME = 1000;     // Long press threshold in ms
     static const unsigned long VERY_LONG_PRESS_TIME = 10000; // Very long press (10 seconds)
     
     // Callback function pointer
     ButtonCallback callback = nullptr;
+
+    static void IRAM_ATTR recordEdge(uint8_t index) {
+        unsigned long now = millis();
+        portENTER_CRITICAL_ISR(&edgeMux);
+        if (!edges[index].pending) {
+            edges[index].firstEdge = now;
+            edges[index].pending = true;
+        }
+        edges[index].lastEdge = now;
+        portEXIT_CRITICAL_ISR(&edgeMux);
+        wakeLoopFromISR();
+    }
+
+    static void IRAM_ATTR onButton1Edge() { recordEdge(0); }
+    static void IRAM_ATTR onButton2Edge() { recordEdge(1); }
     
 public:
     ButtonHandler() {}
@@ -45,6 +69,10 @@ public:
         // Configure button pins as inputs with pull-ups
         pinMode(BUTTON_1, INPUT_PULLUP);
         pinMode(BUTTON_2, INPUT_PULLUP);
+
+        // Edges are timestamped in the interrupt, update() only runs the state machine
+        attachInterrupt(digitalPinToInterrupt(BUTTON_1), onButton1Edge, CHANGE);
+        attachInterrupt(digitalPinToInterrupt(BUTTON_2), onButton2Edge, CHANGE);
     }
     
     void setCallback(ButtonCallback cb) {
@@ -52,13 +80,15 @@ public:
     }
     
     void update() {
+        unsigned long now = millis();
+
         // Check both buttons
-        checkButton(0, BUTTON_1);
-        checkButton(1, BUTTON_2);
+        checkButton(0, BUTTON_1, now);
+        checkButton(1, BUTTON_2, now);
         
         // Check for very long press on both buttons
-        checkVeryLongPress(0, BUTTON_1);
-        checkVeryLongPress(1, BUTTON_2);
+        checkVeryLongPress(0, now);
+        checkVeryLongPress(1, now);
     }
     
     // Returns true if a button is currently being pressed
@@ -72,79 +102,62 @@ public:
         if (buttonIndex >= 2 || !buttonPressed[buttonIndex]) return 0;
         return millis() - buttonPressStartTime[buttonIndex];
     }
+
+    // True while an edge is settling or a button is held - update() needs to run soon
+    bool isActive() {
+        return edges[0].pending || edges[1].pending || buttonPressed[0] || buttonPressed[1];
+    }
     
 private:
-    void checkButton(uint8_t index, uint8_t pin) {
-        // Read the button state (inverted because of pull-up)
-        bool reading = !digitalRead(pin);
-        
-        // Check if the button state has changed
-        if (reading != lastButtonState[index]) {
-            // Reset the debounce timer
-            lastDebounceTime[index] = millis();
+    void checkButton(uint8_t index, uint8_t pin, unsigned long now) {
+        // Take the burst once the pin has been quiet for the debounce time
+        portENTER_CRITICAL(&edgeMux);
+        bool settled = edges[index].pending && (now - edges[index].lastEdge > DEBOUNCE_DELAY);
+        unsigned long edgeTime = edges[index].firstEdge;
+        if (settled) edges[index].pending = false;
+        portEXIT_CRITICAL(&edgeMux);
+
+        if (!settled) return;
+
+        // The settled level decides, so a missed edge can't leave the state wrong
+        bool reading = !digitalRead(pin); // Inverted because of pull-up
+        if (reading == buttonState[index]) return; // Glitch, no change
+        buttonState[index] = reading;
+
+        // Button is pressed - timed from its first edge, not from when we noticed
+        if (reading) {
+            buttonPressStartTime[index] = edgeTime;
+            buttonPressed[index] = true;
+            veryLongPressTriggered[index] = false;
         }
-        
-        // Wait for debounce period
-        if ((millis() - lastDebounceTime[index]) > DEBOUNCE_DELAY) {
-            // If the button state has changed and is stable
-            if (reading != buttonState[index]) {
-                buttonState[index] = reading;
-                
-                // Button is pressed
-                if (buttonState[index] == true) {
-                    buttonPressStartTime[index] = millis();
-                    buttonPressed[index] = true;
-                    
-                    // Start very long press tracking
-                    veryLongPressActive[index] = true;
-                    veryLongPressTriggered[index] = false;
-                }
-                // Button is released
-                else if (buttonPressed[index]) {
-                    buttonPressed[index] = false;
-                    unsigned long pressDuration = millis() - buttonPressStartTime[index];
-                    
-                    // Reset very long press tracking
-                    veryLongPressActive[index] = false;
-                    
-                    // If very long press wasn't triggered yet
-                    if (!veryLongPressTriggered[index]) {
-                        // Call the callback if it exists
-                        if (callback != nullptr) {
-                            ButtonPressType type = (pressDuration >= LONG_PRESS_TIME) ? 
-                                LONG_PRESS : SHORT_PRESS;
-                            callback(index, type);
-                        }
-                    }
-                }
+        // Button is released
+        else if (buttonPressed[index]) {
+            buttonPressed[index] = false;
+            unsigned long pressDuration = edgeTime - buttonPressStartTime[index];
+            
+            // If very long press wasn't triggered yet
+            if (!veryLongPressTriggered[index] && callback != nullptr) {
+                ButtonPressType type = (pressDuration >= LONG_PRESS_TIME) ? 
+                    LONG_PRESS : SHORT_PRESS;
+                callback(index, type);
             }
         }
-        
-        // Save the current reading for next comparison
-        lastButtonState[index] = reading;
     }
     
-    void checkVeryLongPress(uint8_t index, uint8_t pin) {
-        if (veryLongPressActive[index]) {
-            // If button is still pressed
-            if (!digitalRead(pin)) {
-                unsigned long pressDuration = millis() - buttonPressStartTime[index];
-                
-                // If we've reached very long press time and haven't triggered yet
-                if (pressDuration >= VERY_LONG_PRESS_TIME && !veryLongPressTriggered[index]) {
-                    veryLongPressTriggered[index] = true;
-                    
-                    // Call the callback with VERY_LONG_PRESS type
-                    if (callback != nullptr) {
-                        callback(index, VERY_LONG_PRESS);
-                    }
-                }
-            } else {
-                // Button was released before reaching very long press threshold
-                veryLongPressActive[index] = false;
+    void checkVeryLongPress(uint8_t index, unsigned long now) {
+        if (!buttonPressed[index] || veryLongPressTriggered[index]) return;
+
+        // Fires while still held, release is then ignored
+        if (now - buttonPressStartTime[index] >= VERY_LONG_PRESS_TIME) {
+            veryLongPressTriggered[index] = true;
+            if (callback != nullptr) {
+                callback(index, VERY_LONG_PRESS);
             }
         }
     }
 };
 
-#endif // BUTTON_HANDLER_H
\ No newline at end of file
+ButtonEdges ButtonHandler::edges[2] = {{0, 0, false}, {0, 0, false}};
+portMUX_TYPE ButtonHandler::edgeMux = portMUX_INITIALIZER_UNLOCKED;
+
+#endif // BUTTON_HANDLER_H
@@ -0,0 +1,198 @@
+#ifndef EVENT_STREAM_H
+#define EVENT_STREAM_H
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include <AsyncWebSocket.h>
+#include <ESPAsyncWebServer.h>
+#include "GameEvents.h"
+
+extern AsyncWebServer server;
+
+// Game events on their own WebSocket at /events, separate from the per-tick state on /ws.
+// On connect a client gets {"type":"hello","seq":<last event>} and then every event type.
+// It can narrow that down and catch up after a reconnect:
+//   {"subscribe":["goal","clockStopped"]}   only these types from now on
+//   {"since":41}                            replay events after 41 still in the history
+// A replay that can't reach back far enough starts with {"type":"gap","oldest":<seq>}
+// so the consumer knows to take a fresh snapshot from /ws.
+AsyncWebSocket eventSocket("/events");
+
+class GameEventStream {
+private:
+    static const uint8_t MAX_CLIENTS = 8;
+    static const uint32_t ALL_TYPES = (1UL << GAME_EVENT_TYPE_COUNT) - 1;
+
+    struct Subscriber {
+        bool used;
+        uint32_t clientId;
+        uint32_t mask;  // A bit per GameEventType
+    };
+
+    GameEventHistory history;
+    Subscriber subscribers[MAX_CLIENTS];
+
+    // Events are published on the loop task, clients come and go on the async_tcp task
+    portMUX_TYPE lock = portMUX_INITIALIZER_UNLOCKED;
+
+    char jsonBuffer[GAME_EVENT_JSON_CAPACITY];
+
+    Subscriber* findSubscriber(uint32_t clientId) {
+        for (uint8_t i = 0; i < MAX_CLIENTS; i++) {
+            if (subscribers[i].used && subscribers[i].clientId == clientId) return &subscribers[i];
+        }
+        return nullptr;
+    }
+
+    uint32_t maskFor(uint32_t clientId) {
+        portENTER_CRITICAL(&lock);
+        Subscriber* subscriber = findSubscriber(clientId);
+        uint32_t mask = subscriber != nullptr ? subscriber->mask : 0;
+        portEXIT_CRITICAL(&lock);
+        return mask;
+    }
+
+    void replay(uint32_t clientId, uint32_t since) {
+        portENTER_CRITICAL(&lock);
+        uint32_t last = history.getLastSequence();
+        uint32_t oldest = history.getOldestSequence();
+        portEXIT_CRITICAL(&lock);
+        if (since == last) return;
+
+        // Ahead of us means the bridge restarted and its numbering with it
+        if (since > last || since + 1 < oldest) {
+            char gap[48];
+            snprintf(gap, sizeof(gap), "{\"type\":\"gap\",\"oldest\":%lu}", (unsigned long)oldest);
+            eventSocket.text(clientId, gap);
+            if (last == 0) return;
+            since = oldest - 1;
+        }
+
+        uint32_t mask = maskFor(clientId);
+        char buffer[GAME_EVENT_JSON_CAPACITY];
+        for (uint32_t sequence = since + 1; sequence <= last; sequence++) {
+            GameEvent event;
+            portENTER_CRITICAL(&lock);
+            bool kept = history.get(sequence, event);
+            portEXIT_CRITICAL(&lock);
+            if (!kept || !(mask & (1UL << event.type))) continue;
+            size_t length = formatGameEventJson(buffer, sizeof(buffer), event, micros());
+            if (length > 0) eventSocket.text(clientId, buffer, length);
+        }
+    }
+
+public:
+    GameEventStream() {
+        for (uint8_t i = 0; i < MAX_CLIENTS; i++) subscribers[i].used = false;
+    }
+
+    // Loop task. Numbers the event, keeps it for replays and sends it to everyone subscribed.
+    void publish(GameEvent& event) {
+        portENTER_CRITICAL(&lock);
+        history.add(event);
+        portEXIT_CRITICAL(&lock);
+
+        if (eventSocket.count() == 0) return;
+        size_t length = formatGameEventJson(jsonBuffer, sizeof(jsonBuffer), event, micros());
+        if (length == 0) return;
+
+        for (uint8_t i = 0; i < MAX_CLIENTS; i++) {
+            portENTER_CRITICAL(&lock);
+            bool send = subscribers[i].used && (subscribers[i].mask & (1UL << event.type));
+            uint32_t clientId = subscribers[i].clientId;
+            portEXIT_CRITICAL(&lock);
+            if (send) eventSocket.text(clientId, jsonBuffer, length);
+        }
+    }
+
+    uint32_t getLastSequence() const { return history.getLastSequence(); }
+
+    // async_tcp task from here on
+    void clientConnected(uint32_t clientId) {
+        portENTER_CRITICAL(&lock);
+        Subscriber* slot = findSubscriber(clientId);
+        for (uint8_t i = 0; i < MAX_CLIENTS && slot == nullptr; i++) {
+            if (!subscribers[i].used) slot = &subscribers[i];
+        }
+        if (slot != nullptr) {
+            slot->used = true;
+            slot->clientId = clientId;
+            slot->mask = ALL_TYPES;
+        }
+        uint32_t last = history.getLastSequence();
+        portEXIT_CRITICAL(&lock);
+
+        if (slot == nullptr) {
+            eventSocket.close(clientId, 1013, "Too many event subscribers");
+            return;
+        }
+        char hello[48];
+        snprintf(hello, sizeof(hello), "{\"type\":\"hello\",\"seq\":%lu}", (unsigned long)last);
+        eventSocket.text(clientId, hello);
+    }
+
+    void clientDisconnected(uint32_t clientId) {
+        portENTER_CRITICAL(&lock);
+        Subscriber* slot = findSubscriber(clientId);
+        if (slot != nullptr) slot->used = false;
+        portEXIT_CRITICAL(&lock);
+    }
+
+    void handleMessage(uint32_t clientId, const char* data, size_t len) {
+        StaticJsonDocument<384> request;
+        if (deserializeJson(request, data, len)) return;
+
+        JsonArray types = request["subscribe"].as<JsonArray>();
+        if (!types.isNull()) {
+            uint32_t mask = 0;
+            for (JsonVariant type : types) {
+                const char* name = type.as<const char*>();
+                for (uint8_t i = 0; name != nullptr && i < GAME_EVENT_TYPE_COUNT; i++) {
+                    if (strcmp(name, GAME_EVENT_NAMES[i]) == 0) mask |= 1UL << i;
+                }
+            }
+            portENTER_CRITICAL(&lock);
+            Subscriber* subscriber = findSubscriber(clientId);
+            if (subscriber != nullptr) subscriber->mask = mask;
+            portEXIT_CRITICAL(&lock);
+        }
+
+        if (!request["since"].isNull()) replay(clientId, request["since"].as<uint32_t>());
+    }
+};
+
+extern GameEventStream gameEventStream;
+
+void onEventSocketEvent(AsyncWebSocket *socket, AsyncWebSocketClient *client, AwsEventType type,
+                        void *arg, uint8_t *data, size_t len) {
+    switch (type) {
+        case WS_EVT_CONNECT:
+            gameEventStream.clientConnected(client->id());
+            break;
+        case WS_EVT_DISCONNECT:
+            gameEventStream.clientDisconnected(client->id());
+            break;
+        case WS_EVT_DATA: {
+            AwsFrameInfo *info = (AwsFrameInfo*)arg;
+            if (info->final && info->index == 0 && info->len == len && info->opcode == WS_TEXT) {
+                gameEventStream.handleMessage(client->id(), (const char*)data, len);
+            }
+            break;
+        }
+        default:
+            break;
+    }
+}
+
+// Used by setupWebSocket() in WebSocketSetup.h
+void setupEventStream() {
+    eventSocket.onEvent(onEventSocketEvent);
+    server.addHandler(&eventSocket);
+}
+
+// Used by cleanupWebSocket() in WebSocketSetup.h
+void cleanupEventStream() {
+    eventSocket.cleanupClients();
+}
+
+#endif // EVENT_STREAM_H
@@ -0,0 +1,151 @@
+// Decoding and validation of the console's serial frames.
+// Plain C++ with no Arduino dependencies so the Linux benchmarks can include it too.
+//
+// Frame layout after the channel digit (see the Data Protocol section of the Readme):
+//   0     channel digit
+//   1     device status 'T' (clock running) or 'D'
+//   2     device number
+//   3-4   minutes
+//   5-6   seconds
+//   7-8   sub-second digits
+//   9-10  home score
+//   11-12 away score
+#ifndef FRAME_DECODER_H
+#define FRAME_DECODER_H
+
+#include <stdio.h>
+#include <string.h>
+
+struct ScoreFrame {
+    char timeFormatted[6] = "00:00";
+    char homeScore[3] = "00";
+    char awayScore[3] = "00";
+    char subSecond[3] = "00";   // Sub-second digits, first one is tenths
+    int channel = 0;
+    char deviceType = 'D';      // 'D' or 'T'
+    char deviceNumber = '0';    // Number after device type
+};
+
+enum FrameDecodeResult {
+    FRAME_DECODED,
+    FRAME_NO_PATTERN,   // No channel digit followed by D/T
+    FRAME_TOO_SHORT     // Pattern found but the frame is cut off
+};
+
+inline bool isFrameDigit(char c) {
+    return c >= '0' && c <= '9';
+}
+
+// Returns the index of the channel digit, or -1 if there is none
+inline int findFrameStart(const char* message, int length) {
+    // First, try the format where digit is followed directly by D or T
+    for (int i = 0; i < length - 1; i++) {
+        if (isFrameDigit(message[i]) && (message[i+1] == 'D' || message[i+1] == 'T')) {
+            return i;
+        }
+    }
+
+    // If that fails, try looking for control character followed by digit then D or T
+    for (int i = 0; i < length - 2; i++) {
+        if (message[i] < 32 && isFrameDigit(message[i+1]) &&
+            (message[i+2] == 'D' || message[i+2] == 'T')) {
+            return i + 1; // Skip control char
+        }
+    }
+
+    return -1;
+}
+
+// Decodes message into frame. Like the original parser, channel and device status are
+// taken as soon as the pattern is found, even if the rest of the frame is cut off.
+inline FrameDecodeResult decodeScoreFrame(const char* message, int length, ScoreFrame& frame,
+                                          int* dataStartOut = nullptr) {
+    int dataStart = findFrameStart(message, length);
+    if (dataStartOut != nullptr) *dataStartOut = dataStart;
+    if (dataStart == -1) return FRAME_NO_PATTERN;
+
+    // Extract components based on the known format
+    frame.channel = message[dataStart] - '0';
+    frame.deviceType = message[dataStart + 1];
+    frame.deviceNumber = message[dataStart + 2];
+
+    // Need enough characters after dataStart
+    if (dataStart + 13 >= length) return FRAME_TOO_SHORT;
+
+    // Format time
+    frame.timeFormatted[0] = message[dataStart + 3];
+    frame.timeFormatted[1] = message[dataStart + 4];
+    frame.timeFormatted[2] = ':';
+    frame.timeFormatted[3] = message[dataStart + 5];
+    frame.timeFormatted[4] = message[dataStart + 6];
+    frame.timeFormatted[5] = '\0';
+
+    // Sub-second digits, kept for the final minute tenths display
+    if (isFrameDigit(message[dataStart + 7]) && isFrameDigit(message[dataStart + 8])) {
+        frame.subSecond[0] = message[dataStart + 7];
+        frame.subSecond[1] = message[dataStart + 8];
+    } else {
+        frame.subSecond[0] = '0';
+        frame.subSecond[1] = '0';
+    }
+    frame.subSecond[2] = '\0';
+
+    frame.homeScore[0] = message[dataStart + 9];
+    frame.homeScore[1] = message[dataStart + 10];
+    frame.homeScore[2] = '\0';
+
+    frame.awayScore[0] = message[dataStart + 11];
+    frame.awayScore[1] = message[dataStart + 12];
+    frame.awayScore[2] = '\0';
+
+    return FRAME_DECODED;
+}
+
+inline bool isScoreFrameTimeValid(const ScoreFrame& frame) {
+    return strlen(frame.timeFormatted) == 5 && frame.timeFormatted[2] == ':' &&
+           isFrameDigit(frame.timeFormatted[0]) && isFrameDigit(frame.timeFormatted[1]) &&
+           isFrameDigit(frame.timeFormatted[3]) && isFrameDigit(frame.timeFormatted[4]);
+}
+
+inline bool isScoreFrameScoreValid(const ScoreFrame& frame) {
+    return strlen(frame.homeScore) == 2 && strlen(frame.awayScore) == 2 &&
+           isFrameDigit(frame.homeScore[0]) && isFrameDigit(frame.homeScore[1]) &&
+           isFrameDigit(frame.awayScore[0]) && isFrameDigit(frame.awayScore[1]);
+}
+
+inline bool isScoreFrameValid(const ScoreFrame& frame) {
+    return isScoreFrameTimeValid(frame) && isScoreFrameScoreValid(frame);
+}
+
+inline bool hasScoreFrameScoreChanged(const ScoreFrame& current, const ScoreFrame& previous) {
+    return strcmp(current.homeScore, previous.homeScore) != 0 ||
+           strcmp(current.awayScore, previous.awayScore) != 0;
+}
+
+// trackTenths: compare the tenths digit too (final minute only)
+inline bool hasScoreFrameChanged(const ScoreFrame& current, const ScoreFrame& previous, bool trackTenths) {
+    return strcmp(current.timeFormatted, previous.timeFormatted) != 0 ||
+           hasScoreFrameScoreChanged(current, previous) ||
+           current.channel != previous.channel ||
+           current.deviceType != previous.deviceType ||
+           (trackTenths && current.subSecond[0] != previous.subSecond[0]);
+}
+
+// Hex and printable-ASCII views of a raw frame for the debug page.
+// hex needs 9 + 3 * length + 1 bytes, ascii 11 + length + 1; longer frames are cut short.
+inline void formatRawFrame(const char* data, int length, char* hex, size_t hexCapacity,
+                           char* ascii, size_t asciiCapacity) {
+    size_t hexPos = (size_t)snprintf(hex, hexCapacity, "Raw hex: ");
+    size_t asciiPos = (size_t)snprintf(ascii, asciiCapacity, "Raw ASCII: ");
+    for (int i = 0; i < length; i++) {
+        if (hexPos + 4 <= hexCapacity) {
+            hexPos += (size_t)snprintf(hex + hexPos, hexCapacity - hexPos, "%02X ", (unsigned char)data[i]);
+        }
+        if (asciiPos + 2 <= asciiCapacity) {
+            ascii[asciiPos++] = (data[i] >= 32 && data[i] <= 126) ? data[i] : '.';
+            ascii[asciiPos] = '\0';
+        }
+    }
+}
+
+#endif // FRAME_DECODER_H
@@ -0,0 +1,171 @@
+// Game events derived from two successive merged states: goals, score corrections,
+// clock start/stop, period expiry and channel switches. Consumers get these instead of
+// diffing every snapshot themselves.
+// Plain C++ with no Arduino dependencies, like FrameDecoder.h.
+#ifndef GAME_EVENTS_H
+#define GAME_EVENTS_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include "FrameDecoder.h"
+
+enum GameEventType {
+    GAME_EVENT_GOAL,              // A side's score went up by one
+    GAME_EVENT_SCORE_CORRECTION,  // Any other score change (operator fixing a mistake, reset)
+    GAME_EVENT_CLOCK_STARTED,
+    GAME_EVENT_CLOCK_STOPPED,
+    GAME_EVENT_PERIOD_EXPIRED,    // Countdown reached 00:00
+    GAME_EVENT_CHANNEL_SWITCHED,  // Console switched to another channel, nothing else is derived from that frame
+    GAME_EVENT_TYPE_COUNT
+};
+
+static const char* const GAME_EVENT_NAMES[GAME_EVENT_TYPE_COUNT] = {
+    "goal", "scoreCorrection", "clockStarted", "clockStopped", "periodExpired", "channelSwitched"
+};
+
+enum GameEventSide {
+    GAME_SIDE_NONE,
+    GAME_SIDE_HOME,
+    GAME_SIDE_AWAY
+};
+
+static const char* const GAME_SIDE_NAMES[] = {"", "home", "away"};
+
+struct GameEvent {
+    GameEventType type = GAME_EVENT_GOAL;
+    GameEventSide side = GAME_SIDE_NONE;
+    int from = 0;              // Score or channel before, for corrections and channel switches
+    int to = 0;
+    // State once the event happened
+    int home = 0;
+    int away = 0;
+    int channel = 0;
+    char time[6] = "00:00";
+    uint32_t sequence = 0;     // Set by the publisher
+    uint32_t arrivalUs = 0;    // UART arrival of the frame behind it
+};
+
+// Most events one frame can produce: stop, expiry, a change per side and a start
+static const int MAX_GAME_EVENTS_PER_FRAME = 5;
+
+// Room for the longest event message
+static const size_t GAME_EVENT_JSON_CAPACITY = 192;
+
+// Numbered events kept for replays. Not locked, GameEventStream guards it.
+class GameEventHistory {
+private:
+    static const uint8_t SIZE = 32;  // A few chukkers of goals and stoppages
+
+    GameEvent events[SIZE];
+    uint32_t lastSequence = 0;  // 0 until the first event
+
+public:
+    // Numbers the event and keeps it in place of the oldest
+    void add(GameEvent& event) {
+        event.sequence = ++lastSequence;
+        events[event.sequence % SIZE] = event;
+    }
+
+    // False if that event was never kept or has been overwritten
+    bool get(uint32_t sequence, GameEvent& event) const {
+        const GameEvent& kept = events[sequence % SIZE];
+        if (sequence == 0 || kept.sequence != sequence) return false;
+        event = kept;
+        return true;
+    }
+
+    uint32_t getLastSequence() const { return lastSequence; }
+    uint32_t getOldestSequence() const { return lastSequence > SIZE ? lastSequence - SIZE + 1 : 1; }
+};
+
+inline int gameEventScore(const char* digits) {
+    return (digits[0] - '0') * 10 + (digits[1] - '0');
+}
+
+inline bool gameEventRunning(const ScoreFrame& frame) {
+    return frame.deviceType == 'T';
+}
+
+// Writes the events between previous and current into events, oldest first. Returns how many.
+inline int detectGameEvents(const ScoreFrame& previous, const ScoreFrame& current,
+                            GameEvent* events, int capacity) {
+    int count = 0;
+    GameEvent base;
+    base.home = gameEventScore(current.homeScore);
+    base.away = gameEventScore(current.awayScore);
+    base.channel = current.channel;
+    memcpy(base.time, current.timeFormatted, sizeof(base.time));
+
+    // Another channel is another game, its scores and clock are not changes to this one
+    if (current.channel != previous.channel) {
+        if (count < capacity) {
+            events[count] = base;
+            events[count].type = GAME_EVENT_CHANNEL_SWITCHED;
+            events[count].from = previous.channel;
+            events[count].to = current.channel;
+            count++;
+        }
+        return count;
+    }
+
+    bool wasRunning = gameEventRunning(previous);
+    bool running = gameEventRunning(current);
+
+    // A goal usually stops the clock in the same frame, the stop comes first
+    if (wasRunning && !running && count < capacity) {
+        events[count] = base;
+        events[count].type = GAME_EVENT_CLOCK_STOPPED;
+        count++;
+    }
+
+    if (strcmp(previous.timeFormatted, "00:00") != 0 && strcmp(current.timeFormatted, "00:00") == 0 &&
+        count < capacity) {
+        events[count] = base;
+        events[count].type = GAME_EVENT_PERIOD_EXPIRED;
+        count++;
+    }
+
+    const int before[2] = {gameEventScore(previous.homeScore), gameEventScore(previous.awayScore)};
+    const int after[2] = {base.home, base.away};
+    for (int side = 0; side < 2; side++) {
+        if (before[side] == after[side] || count >= capacity) continue;
+        events[count] = base;
+        events[count].type = after[side] == before[side] + 1 ? GAME_EVENT_GOAL : GAME_EVENT_SCORE_CORRECTION;
+        events[count].side = side == 0 ? GAME_SIDE_HOME : GAME_SIDE_AWAY;
+        events[count].from = before[side];
+        events[count].to = after[side];
+        count++;
+    }
+
+    if (!wasRunning && running && count < capacity) {
+        events[count] = base;
+        events[count].type = GAME_EVENT_CLOCK_STARTED;
+        count++;
+    }
+    return count;
+}
+
+// Returns the length written, or 0 if buf is too small. Never allocates.
+inline size_t formatGameEventJson(char* buf, size_t capacity, const GameEvent& event, uint32_t sentUs) {
+    int len = snprintf(buf, capacity, "{\"type\":\"%s\",\"seq\":%lu", GAME_EVENT_NAMES[event.type],
+                       (unsigned long)event.sequence);
+    if (len < 0 || (size_t)len >= capacity) return 0;
+
+    if (event.side != GAME_SIDE_NONE) {
+        len += snprintf(buf + len, capacity - len, ",\"side\":\"%s\"", GAME_SIDE_NAMES[event.side]);
+        if ((size_t)len >= capacity) return 0;
+    }
+    if (event.type == GAME_EVENT_SCORE_CORRECTION || event.type == GAME_EVENT_CHANNEL_SWITCHED) {
+        len += snprintf(buf + len, capacity - len, ",\"from\":%d,\"to\":%d", event.from, event.to);
+        if ((size_t)len >= capacity) return 0;
+    }
+    len += snprintf(buf + len, capacity - len,
+                    ",\"home\":%d,\"away\":%d,\"time\":\"%s\",\"channel\":%d,\"ts\":%lu,\"bt\":%lu}",
+                    event.home, event.away, event.time, event.channel,
+                    (unsigned long)event.arrivalUs, (unsigned long)sentUs);
+    if ((size_t)len >= capacity) return 0;
+    return (size_t)len;
+}
+
+#endif // GAME_EVENTS_H
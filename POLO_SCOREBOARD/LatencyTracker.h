@@ -0,0 +1,370 @@
+#ifndef LATENCY_TRACKER_H
+#define LATENCY_TRACKER_H
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+
+// End-to-end latency from a frame landing on the UART to a browser painting it.
+// The bridge times its own stages with micros(). Pages opened with ?latency echo each
+// update back with their receive and paint times, which gives the network and browser
+// stages. All histograms use log2 microsecond buckets so recording is a few instructions.
+// Pages also run an NTP-style clock sync over /ws and report each round trip, which
+// gives a per-client RTT and the playout delay used to render updates in step.
+
+enum LatencyStage {
+    LATENCY_INGEST,   // UART arrival to decoded state change
+    LATENCY_QUEUE,    // Decoded to its broadcast slot (phase rate limiting)
+    LATENCY_SEND,     // Serialize and hand to every WebSocket
+    LATENCY_NETWORK,  // Bridge to browser, one way (half the echo round trip)
+    LATENCY_CLIENT,   // Browser receive to paint
+    LATENCY_TOTAL,    // UART arrival to paint
+    LATENCY_STAGE_COUNT
+};
+
+static const char* const LATENCY_STAGE_NAMES[LATENCY_STAGE_COUNT] = {
+    "ingest", "queue", "send", "network", "client", "total"
+};
+
+class LatencyHistogram {
+public:
+    // Bucket n counts values in [2^n, 2^(n+1)) us, bucket 0 also takes 0 and the last is open ended
+    static const uint8_t BUCKETS = 24; // Last bucket starts at ~8.4 s
+
+    uint32_t counts[BUCKETS];
+    uint32_t count;
+    uint32_t maxUs;
+    uint64_t sumUs;
+
+    LatencyHistogram() {
+        reset();
+    }
+
+    void reset() {
+        memset(counts, 0, sizeof(counts));
+        count = 0;
+        maxUs = 0;
+        sumUs = 0;
+    }
+
+    void record(uint32_t us) {
+        uint8_t bucket = us == 0 ? 0 : 31 - __builtin_clz(us);
+        if (bucket >= BUCKETS) bucket = BUCKETS - 1;
+        counts[bucket]++;
+        count++;
+        sumUs += us;
+        if (us > maxUs) maxUs = us;
+    }
+
+    // Upper edge of the bucket holding the percentile, never more than the max seen
+    uint32_t percentile(uint8_t pct) const {
+        if (count == 0) return 0;
+        uint32_t target = (uint32_t)(((uint64_t)count * pct + 99) / 100);
+        uint32_t seen = 0;
+        for (uint8_t i = 0; i < BUCKETS; i++) {
+            seen += counts[i];
+            if (seen >= target) {
+                uint32_t upper = (i + 1 >= BUCKETS) ? maxUs : ((1UL << (i + 1)) - 1);
+                return upper < maxUs ? upper : maxUs;
+            }
+        }
+        return maxUs;
+    }
+
+    void toJson(JsonObject out, bool withBuckets) const {
+        out["count"] = count;
+        out["meanUs"] = count ? (uint32_t)(sumUs / count) : 0;
+        out["p50Us"] = percentile(50);
+        out["p90Us"] = percentile(90);
+        out["p99Us"] = percentile(99);
+        out["maxUs"] = maxUs;
+        if (!withBuckets) return;
+        JsonArray buckets = out.createNestedArray("buckets");
+        for (uint8_t i = 0; i < BUCKETS; i++) {
+            buckets.add(counts[i]);
+        }
+    }
+};
+
+class LatencyTracker {
+public:
+    static const uint8_t MAX_CLIENTS = 8;   // AsyncWebSocket's default client limit
+    static const uint8_t SENT_HISTORY = 8;  // Updates an echo can still be matched against
+
+    // Playout delay: updates are shown at their send time plus this on every screen,
+    // enough for the slowest synced client's one-way trip and jitter
+    static const uint32_t PLAYOUT_MIN_MS = 50;
+    static const uint32_t PLAYOUT_MAX_MS = 1000;
+    static const uint32_t PLAYOUT_MARGIN_MS = 20;  // Timer and paint slack on the page
+
+private:
+    struct SentUpdate {
+        uint32_t sequence;
+        uint32_t arrivalUs;  // UART arrival of the frame behind this update
+        uint32_t sentUs;     // Handed to the WebSocket clients
+        bool used;
+    };
+
+    struct ClientLatency {
+        uint32_t clientId;
+        bool used;
+        uint32_t echoes;
+        uint32_t unmatched;  // Echoes for updates that already left the history
+        LatencyHistogram network;
+        LatencyHistogram client;
+        LatencyHistogram total;
+
+        // Clock sync round trips reported by the page
+        uint32_t remoteIp;
+        uint32_t syncs;
+        uint32_t lastRttUs;
+        uint32_t smoothedRttUs;  // RFC 6298 style, 0 until the first sample
+        uint32_t rttVarUs;
+        LatencyHistogram rtt;
+    };
+
+    LatencyHistogram stages[LATENCY_STAGE_COUNT];
+    ClientLatency clients[MAX_CLIENTS];
+    SentUpdate sent[SENT_HISTORY];
+    uint8_t sentNext = 0;
+    LatencyHistogram roundTrips;  // All clients' clock sync round trips
+    uint32_t droppedClients = 0;  // Echoes from clients beyond MAX_CLIENTS
+
+    // Stages are recorded on the loop task, echoes and reports run on the async_tcp task
+    portMUX_TYPE lock = portMUX_INITIALIZER_UNLOCKED;
+
+    ClientLatency* findClient(uint32_t clientId, bool create) {
+        ClientLatency* freeSlot = nullptr;
+        for (uint8_t i = 0; i < MAX_CLIENTS; i++) {
+            if (clients[i].used && clients[i].clientId == clientId) return &clients[i];
+            if (!clients[i].used && freeSlot == nullptr) freeSlot = &clients[i];
+        }
+        if (!create || freeSlot == nullptr) return nullptr;
+
+        freeSlot->used = true;
+        freeSlot->clientId = clientId;
+        freeSlot->echoes = 0;
+        freeSlot->unmatched = 0;
+        freeSlot->network.reset();
+        freeSlot->client.reset();
+        freeSlot->total.reset();
+        freeSlot->remoteIp = 0;
+        freeSlot->syncs = 0;
+        freeSlot->lastRttUs = 0;
+        freeSlot->smoothedRttUs = 0;
+        freeSlot->rttVarUs = 0;
+        freeSlot->rtt.reset();
+        return freeSlot;
+    }
+
+public:
+    LatencyTracker() {
+        for (uint8_t i = 0; i < MAX_CLIENTS; i++) clients[i].used = false;
+        for (uint8_t i = 0; i < SENT_HISTORY; i++) sent[i].used = false;
+    }
+
+    void recordStage(LatencyStage stage, uint32_t us) {
+        portENTER_CRITICAL(&lock);
+        stages[stage].record(us);
+        portEXIT_CRITICAL(&lock);
+    }
+
+    // Remember when an update went out so echoes can be matched to it
+    void recordSent(uint32_t sequence, uint32_t arrivalUs, uint32_t sentUs) {
+        portENTER_CRITICAL(&lock);
+        SentUpdate& entry = sent[sentNext];
+        entry.sequence = sequence;
+        entry.arrivalUs = arrivalUs;
+        entry.sentUs = sentUs;
+        entry.used = true;
+        sentNext = (sentNext + 1) % SENT_HISTORY;
+        portEXIT_CRITICAL(&lock);
+    }
+
+    // A page's echo: receivedMs and paintedMs are on the page's own clock, only their
+    // difference is used. The rest of the round trip is split evenly between the two directions.
+    void recordEcho(uint32_t clientId, uint32_t sequence, uint32_t stamp, double receivedMs, double paintedMs) {
+        uint32_t nowUs = micros();
+        double clientMs = paintedMs - receivedMs;
+        uint32_t clientUs = (clientMs > 0 && clientMs < 60000) ? (uint32_t)(clientMs * 1000) : 0;
+
+        portENTER_CRITICAL(&lock);
+        ClientLatency* slot = findClient(clientId, true);
+        if (slot == nullptr) {
+            droppedClients++;
+            portEXIT_CRITICAL(&lock);
+            return;
+        }
+        slot->echoes++;
+
+        const SentUpdate* update = nullptr;
+        for (uint8_t i = 0; i < SENT_HISTORY; i++) {
+            if (sent[i].used && sent[i].sequence == sequence && sent[i].arrivalUs == stamp) {
+                update = &sent[i];
+                break;
+            }
+        }
+        if (update == nullptr) {
+            slot->unmatched++;
+            portEXIT_CRITICAL(&lock);
+            return;
+        }
+
+        uint32_t roundTripUs = nowUs - update->sentUs;
+        uint32_t networkUs = roundTripUs > clientUs ? (roundTripUs - clientUs) / 2 : 0;
+        uint32_t totalUs = (update->sentUs - update->arrivalUs) + networkUs + clientUs;
+
+        stages[LATENCY_NETWORK].record(networkUs);
+        stages[LATENCY_CLIENT].record(clientUs);
+        stages[LATENCY_TOTAL].record(totalUs);
+        slot->network.record(networkUs);
+        slot->client.record(clientUs);
+        slot->total.record(totalUs);
+        portEXIT_CRITICAL(&lock);
+    }
+
+    // A page's clock sync round trip: its own measurement of the previous exchange,
+    // (receive - send) less the time the bridge held the request
+    void recordRoundTrip(uint32_t clientId, uint32_t remoteIp, uint32_t rttUs) {
+        portENTER_CRITICAL(&lock);
+        ClientLatency* slot = findClient(clientId, true);
+        if (slot == nullptr) {
+            droppedClients++;
+            portEXIT_CRITICAL(&lock);
+            return;
+        }
+        slot->remoteIp = remoteIp;
+        slot->syncs++;
+        slot->lastRttUs = rttUs;
+        if (slot->smoothedRttUs == 0) {
+            slot->smoothedRttUs = rttUs;
+            slot->rttVarUs = rttUs / 2;
+        } else {
+            uint32_t error = rttUs > slot->smoothedRttUs ? rttUs - slot->smoothedRttUs : slot->smoothedRttUs - rttUs;
+            slot->rttVarUs = (slot->rttVarUs * 3 + error) / 4;
+            slot->smoothedRttUs = (slot->smoothedRttUs * 7 + rttUs) / 8;
+        }
+        slot->rtt.record(rttUs);
+        roundTrips.record(rttUs);
+        portEXIT_CRITICAL(&lock);
+    }
+
+    // Sent to pages with every clock sync reply
+    uint32_t getPlayoutMs() {
+        uint32_t worstUs = 0;
+        portENTER_CRITICAL(&lock);
+        for (uint8_t i = 0; i < MAX_CLIENTS; i++) {
+            if (!clients[i].used || clients[i].smoothedRttUs == 0) continue;
+            uint32_t oneWayUs = clients[i].smoothedRttUs / 2 + 4 * clients[i].rttVarUs;
+            if (oneWayUs > worstUs) worstUs = oneWayUs;
+        }
+        portEXIT_CRITICAL(&lock);
+
+        uint32_t playoutMs = worstUs / 1000 + PLAYOUT_MARGIN_MS;
+        if (playoutMs < PLAYOUT_MIN_MS) return PLAYOUT_MIN_MS;
+        if (playoutMs > PLAYOUT_MAX_MS) return PLAYOUT_MAX_MS;
+        return playoutMs;
+    }
+
+    void removeClient(uint32_t clientId) {
+        portENTER_CRITICAL(&lock);
+        ClientLatency* slot = findClient(clientId, false);
+        if (slot != nullptr) slot->used = false;
+        portEXIT_CRITICAL(&lock);
+    }
+
+    void reset() {
+        portENTER_CRITICAL(&lock);
+        for (uint8_t i = 0; i < LATENCY_STAGE_COUNT; i++) stages[i].reset();
+        for (uint8_t i = 0; i < MAX_CLIENTS; i++) {
+            clients[i].network.reset();
+            clients[i].client.reset();
+            clients[i].total.reset();
+            clients[i].rtt.reset();
+            clients[i].syncs = 0;
+            clients[i].echoes = 0;
+            clients[i].unmatched = 0;
+        }
+        roundTrips.reset();
+        droppedClients = 0;
+        portEXIT_CRITICAL(&lock);
+    }
+
+    // Snapshot for the /latency route, buckets only for the stage totals to keep it small. Each histogram is copied under the lock, then formatted outside it.
+    String toJson() {
+        DynamicJsonDocument doc(12288);
+        LatencyHistogram copy;
+
+        JsonObject stageObj = doc.createNestedObject("stages");
+        for (uint8_t i = 0; i < LATENCY_STAGE_COUNT; i++) {
+            portENTER_CRITICAL(&lock);
+            copy = stages[i];
+            portEXIT_CRITICAL(&lock);
+            copy.toJson(stageObj.createNestedObject(LATENCY_STAGE_NAMES[i]), true);
+        }
+
+        JsonArray clientArr = doc.createNestedArray("clients");
+        for (uint8_t i = 0; i < MAX_CLIENTS; i++) {
+            portENTER_CRITICAL(&lock);
+            bool used = clients[i].used;
+            uint32_t clientId = clients[i].clientId;
+            uint32_t echoes = clients[i].echoes;
+            uint32_t unmatched = clients[i].unmatched;
+            uint32_t remoteIp = clients[i].remoteIp;
+            uint32_t syncs = clients[i].syncs;
+            uint32_t lastRttUs = clients[i].lastRttUs;
+            uint32_t smoothedRttUs = clients[i].smoothedRttUs;
+            uint32_t rttVarUs = clients[i].rttVarUs;
+            portEXIT_CRITICAL(&lock);
+            if (!used) continue;
+
+            JsonObject entry = clientArr.createNestedObject();
+            entry["id"] = clientId;
+            if (remoteIp != 0) entry["ip"] = IPAddress(remoteIp).toString();
+            entry["echoes"] = echoes;
+            entry["unmatched"] = unmatched;
+            entry["syncs"] = syncs;
+            entry["rttUs"] = smoothedRttUs;
+            entry["rttVarUs"] = rttVarUs;
+            entry["lastRttUs"] = lastRttUs;
+
+            portENTER_CRITICAL(&lock);
+            copy = clients[i].network;
+            portEXIT_CRITICAL(&lock);
+            copy.toJson(entry.createNestedObject("network"), false);
+            portENTER_CRITICAL(&lock);
+            copy = clients[i].client;
+            portEXIT_CRITICAL(&lock);
+            copy.toJson(entry.createNestedObject("client"), false);
+            portENTER_CRITICAL(&lock);
+            copy = clients[i].total;
+            portEXIT_CRITICAL(&lock);
+            copy.toJson(entry.createNestedObject("total"), false);
+            portENTER_CRITICAL(&lock);
+            copy = clients[i].rtt;
+            portEXIT_CRITICAL(&lock);
+            copy.toJson(entry.createNestedObject("rtt"), false);
+        }
+
+        portENTER_CRITICAL(&lock);
+        copy = roundTrips;
+        portEXIT_CRITICAL(&lock);
+        copy.toJson(doc.createNestedObject("rtt"), true);
+        doc["playoutMs"] = getPlayoutMs();
+        doc["droppedClients"] = droppedClients;
+
+        String json;
+        serializeJson(doc, json);
+        return json;
+    }
+};
+
+extern LatencyTracker latencyTracker;
+
+// Used by the /latency route in WebRoutes.h
+String getLatencyReport(bool reset) {
+    String report = latencyTracker.toJson();
+    if (reset) latencyTracker.reset();
+    return report;
+}
+
+#endif // LATENCY_TRACKER_H
@@ -0,0 +1,32 @@
+#ifndef LOOP_WAKE_H
+#define LOOP_WAKE_H
+
+#include <Arduino.h>
+
+// Lets interrupts and driver callbacks cut the loop's idle wait short,
+// so the loop can sleep between events without adding latency
+
+TaskHandle_t loopTaskHandle = nullptr;
+
+// Call from setup() - setup() and loop() run on the same task
+void initLoopWake() {
+    loopTaskHandle = xTaskGetCurrentTaskHandle();
+}
+
+void IRAM_ATTR wakeLoopFromISR() {
+    if (loopTaskHandle == nullptr) return;
+    BaseType_t higherPriorityWoken = pdFALSE;
+    vTaskNotifyGiveFromISR(loopTaskHandle, &higherPriorityWoken);
+    if (higherPriorityWoken) portYIELD_FROM_ISR();
+}
+
+void wakeLoop() {
+    if (loopTaskHandle != nullptr) xTaskNotifyGive(loopTaskHandle);
+}
+
+// Blocks for up to timeoutMs, returns early when woken
+void waitForWake(uint32_t timeoutMs) {
+    ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(timeoutMs));
+}
+
+#endif // LOOP_WAKE_H
@@ -0,0 +1,57 @@
+#ifndef MULTICAST_PUBLISHER_H
+#define MULTICAST_PUBLISHER_H
+
+#include <Arduino.h>
+#include <WiFi.h>
+#include <AsyncUDP.h>
+#include "StatePacket.h"
+
+// Publishes each state update once as a UDP multicast datagram,
+// so secondary displays on the LAN don't each need a WebSocket slot
+class MulticastPublisher {
+private:
+    AsyncUDP udp;
+    IPAddress group = IPAddress(239, 255, 42, 42); // STATE_MULTICAST_GROUP
+    uint16_t port = STATE_MULTICAST_PORT;
+    bool enabled = false;
+    unsigned long sentPackets = 0;
+    unsigned long failedPackets = 0;
+    uint32_t bootId = 0; // Lets receivers tell a reboot from reordering whatever the sequence does
+
+public:
+    MulticastPublisher() {}
+
+    void setEnabled(bool enable) {
+        enabled = enable;
+    }
+
+    bool isEnabled() const {
+        return enabled;
+    }
+
+    void publish(const StatePacket& packet) {
+        if (!enabled || WiFi.status() != WL_CONNECTED) return;
+
+        // Picked on the first send, with Wi-Fi up esp_random() is truly random
+        if (bootId == 0) bootId = esp_random() | 1;
+        StatePacket stamped = packet;
+        stamped.bootId = bootId;
+
+        uint8_t buf[STATE_PACKET_SIZE];
+        size_t len = encodeStatePacket(stamped, buf, sizeof(buf));
+        if (len == 0) return;
+
+        if (udp.writeTo(buf, len, group, port) == len) {
+            sentPackets++;
+        } else {
+            failedPackets++;
+        }
+    }
+
+    unsigned long getSentPackets() const { return sentPackets; }
+    unsigned long getFailedPackets() const { return failedPackets; }
+};
+
+extern MulticastPublisher multicastPublisher;
+
+#endif // MULTICAST_PUBLISHER_H
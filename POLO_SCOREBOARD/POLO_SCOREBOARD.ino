@@ -7,6 +7,13 @@
 #include "WebSocketSetup.h"
 #include "SerialHandler.h"  
 #include "ButtonHandler.h"
+#include "MulticastPublisher.h"
+#include "PowerManager.h"
+#include "LoopWake.h"
+#include "Bench.h"
+#include "Parameters.h"
+#include "StallMonitor.h"
+#include "Profiler.h"
 #include <Preferences.h>
 
 // Initialize components
@@ -14,125 +21,146 @@ TFT_eSPI tft = TFT_eSPI();
 WiFiManager wm;
 SerialHandler serialHandler;
 ButtonHandler buttonHandler;
+MulticastPublisher multicastPublisher;
+PowerManager powerManager;
+BenchRunner benchRunner;
+LatencyTracker latencyTracker;
 Preferences preferences;
+Parameters parameters;
+StallMonitor stallMonitor;
+GameEventStream gameEventStream;
+StateSnapshot stateSnapshot;
+Profiler profiler;
+StateRestore stateRestore;
 
 bool systemInitialized = false;
+bool webServerStarted = false;
 bool displayingScoreboard = false;
 bool displayingWebsiteURL = false;
 unsigned long lastScoreboardUpdate = 0;
-const unsigned long SCOREBOARD_UPDATE_INTERVAL = 5000; // 5 seconds
 
 bool inConfigPortalMode = false;
 
 void setup() {
   Serial.begin(115200);
-  delay(1000);
+  initLoopWake(); // Before anything that can wake the loop
 
   // Initialize preferences
   preferences.begin("scoreboard", false); // false = read/write mode
+  parameters.load(); // Tuned timings, before anything that uses them
   // Load debug setting
   bool debugMode = preferences.getBool("debugMode", false); // default to false if not set
   serialHandler.setDebug(debugMode);
+  // Load UDP multicast setting
+  multicastPublisher.setEnabled(preferences.getBool("udpMulticast", false));
 
   initDisplay();
-  displayMessage("Initializing...");
+
+  // Last score from before the restart, for the screen and the first clients
+  if (serialHandler.restoreState()) {
+    Serial.printf("Restored %s %s - %s\n", serialHandler.getTimeFormatted(),
+                  serialHandler.getHomeScore(), serialHandler.getAwayScore());
+  }
+
+  // UART ingest comes up first so no frame is lost while Wi-Fi connects
+  // On failure carry on - the stale input check retries the port, a restart would only lose the display
+  if (!serialHandler.begin()) {
+    displayMessage("Serial Failed!");
+    delay(3000);
+  }
+  // Second console input, off unless configured on the settings page
+  serialHandler.setSecondSourceRole((SourceRole)preferences.getUChar("uart2Role", SOURCE_DISABLED));
+
+  // Local display shows the score straight away
+  displayScoreData();
+  displayingScoreboard = true;
+  lastScoreboardUpdate = millis();
+
   buttonHandler.begin();
   buttonHandler.setCallback(handleButtonPress);
+  powerManager.begin();
+  benchRunner.begin();
+
+  // Wi-Fi connects in the background, the web server starts once an IP is assigned
+  startWiFi();
+  stallMonitor.begin(); // Task watchdog on the loop from here on
 }
 
 void loop() {
-  // Check if in config portal mode
-  if (inConfigPortalMode) {
-    // Don't do anything that would override the AP display
-    delay(100);
-    return;
-  }
-
-  // System initialization phase
-  if (!systemInitialized) {
-    // First, ensure WiFi is connected
-    if (WiFi.status() != WL_CONNECTED) {
-      if (!setupWiFi()) {
-        displayMessage("WiFi Failed! Retrying...");
-        delay(5000);
-        return; // Try again next loop iteration
-      }
-      displayMessage("WiFi Connected!");
-      delay(1000); // Give WiFi time to stabilize
-
-    }
-    
-    // Now that WiFi is connected, set up WebSocket
-    displayMessage("Starting WebSocket...");
-    setupWebSocket();
-    delay(2000); // Add delay to let the WebSocket server initialize properly
-    
-    
-    // Finally, initialize serial
-    if (!serialHandler.begin()) {
-      displayMessage("Serial Failed!");
-      delay(3000);
-      ESP.restart();
+  stallMonitor.beginIteration(); // Feeds the task watchdog
+  // Bring the web server up as soon as there is an IP address
+  if (updateWiFi()) {
+    // The server, mDNS and UART are started once and stay up across Wi-Fi outages
+    if (!webServerStarted) {
+      initFS();
+      setupWebSocket();
+      webServerStarted = true;
     }
-    
-    // All systems go!
     systemInitialized = true;
-    displayMessage("System Ready!");
-    delay(1000);
-
-    // Show the website URL screen after initialization
-    displayWebsiteURL();
-    displayingWebsiteURL = true;
-    return;
+    serialHandler.setNetworkOnline(true); // Sends one coalesced catch-up
+    if (displayingScoreboard) {
+      displayScoreData(); // Redraw in case the config portal had the screen
+    } else {
+      displayWebsiteURL();
+      displayingWebsiteURL = true;
+    }
   }
-  
-  // Normal operation - only when fully initialized
-  if (WiFi.status() != WL_CONNECTED) {
-    systemInitialized = false; // Force re-initialization
-    displayMessage("WiFi disconnected!");
-    return;
+
+  // Link lost: keep ingesting and recording, the scoreboard screen shows the outage
+  if (systemInitialized && WiFi.status() != WL_CONNECTED) {
+    systemInitialized = false;
+    serialHandler.setNetworkOnline(false);
+    Serial.println("WiFi disconnected - buffering updates until it returns");
   }
 
-  static unsigned long lastUpdateTime = 0;
   static unsigned long lastBaudCheck = 0;
   static unsigned long lastResetCheck = 0;
   unsigned long currentMillis = millis();
 
-  // Periodic state broadcast
-  if (currentMillis - lastUpdateTime > 30000) { // Every 30 seconds
-    serialHandler.sendCurrentState();
-    lastUpdateTime = currentMillis;
-  }
-
   // Baud rate checking (less frequent)
-  if (currentMillis - lastBaudCheck > 60000) { // Every 60 seconds
+  if (currentMillis - lastBaudCheck > parameters.get(PARAM_BAUD_CHECK)) {
     serialHandler.detectBaudRate();
     lastBaudCheck = currentMillis;
   }
 
   // Reset Serial after extended garbled data (failsafe)
-  if (currentMillis - lastResetCheck > 300000) { // Every 5 minutes
-    if (!serialHandler.hasReceivedValidData(180000)) { // No valid data for 3 minutes
-      if (serialHandler.getDebug()) {
-        serialHandler.debugWS("No valid data for extended period - resetting serial");
-      }
-      serialHandler.begin(); // Reinitialize the serial connection
-    }
+  if (currentMillis - lastResetCheck > parameters.get(PARAM_STALE_CHECK)) {
+    serialHandler.resetStaleSources(parameters.get(PARAM_STALE_TIMEOUT));
     lastResetCheck = currentMillis;
   }
 
-  // Update scoreboard display if active
-  if (displayingScoreboard) {
-    if (currentMillis - lastScoreboardUpdate >= SCOREBOARD_UPDATE_INTERVAL) {
+  // Update scoreboard display if active - right away on a change, otherwise on the interval
+  // The config portal owns the screen while it is open
+  if (displayingScoreboard && !inConfigPortalMode) {
+    if (scoreDisplayChanged() || currentMillis - lastScoreboardUpdate >= parameters.get(PARAM_DISPLAY_REFRESH)) {
       displayScoreData();
       lastScoreboardUpdate = currentMillis;
     }
   }
 
-  buttonHandler.update();
+  if (!inConfigPortalMode) {
+    buttonHandler.update();
+  }
   serialHandler.handleData();
+  serialHandler.updateBroadcast(); // Phase-aware rate: changes, 1 Hz play, 10 Hz final minute, heartbeat
+  stateRestore.update(); // Throttled NVS copy of the last state
   cleanupWebSocket();
-  delay(10);
+  benchRunner.update(); // Only does anything after /bench?run=1
+
+  // Score changes and button presses keep the display bright, otherwise dim and slow down
+  static unsigned long lastStateChanges = 0;
+  bool buttonActive = buttonHandler.isActive();
+  if (buttonActive || serialHandler.getStateChanges() != lastStateChanges) {
+    lastStateChanges = serialHandler.getStateChanges();
+    powerManager.noteActivity();
+  }
+  powerManager.update(serialHandler.getLastByteTime(), serialHandler.canLightSleep());
+
+  // Loop timing, pings and stall recovery - before the wait so only work is measured
+  stallMonitor.endIteration();
+
+  // Sleep until the next UART frame or button edge, or a short timeout for timers
+  powerManager.wait(buttonActive || serialHandler.isBusy());
 }
 
 void handleButtonPress(uint8_t button, ButtonPressType type) {
@@ -216,7 +244,31 @@ void handleButtonPress(uint8_t button, ButtonPressType type) {
 }
 
 
+// What the scoreboard screen last drew
+char shownTime[6] = "";
+char shownHome[3] = "";
+char shownAway[3] = "";
+bool shownRunning = false;
+bool shownOnline = false;
+char shownShot[6] = "";
+
+bool scoreDisplayChanged() {
+  return strcmp(shownTime, serialHandler.getTimeFormatted()) != 0 ||
+         strcmp(shownHome, serialHandler.getHomeScore()) != 0 ||
+         strcmp(shownAway, serialHandler.getAwayScore()) != 0 ||
+         shownRunning != serialHandler.isTimeRunning() ||
+         shownOnline != serialHandler.isNetworkOnline() ||
+         (serialHandler.hasShotClock() && strcmp(shownShot, serialHandler.getShotClock()) != 0);
+}
+
 void displayScoreData() {
+  strncpy(shownTime, serialHandler.getTimeFormatted(), sizeof(shownTime) - 1);
+  strncpy(shownHome, serialHandler.getHomeScore(), sizeof(shownHome) - 1);
+  strncpy(shownAway, serialHandler.getAwayScore(), sizeof(shownAway) - 1);
+  shownRunning = serialHandler.isTimeRunning();
+  shownOnline = serialHandler.isNetworkOnline();
+  strncpy(shownShot, serialHandler.hasShotClock() ? serialHandler.getShotClock() : "", sizeof(shownShot) - 1);
+
   // Clear screen
   tft.fillScreen(TFT_BLACK);
   
@@ -225,6 +277,24 @@ void displayScoreData() {
   tft.setTextColor(TFT_WHITE, TFT_BLACK);
   tft.setTextSize(1);
   tft.drawString("SCOREBOARD", tft.width()/2, 5);
+
+  // Network status in the corner, the score stays up during an outage
+  if (!shownOnline) {
+    tft.setTextDatum(TR_DATUM);
+    tft.setTextColor(TFT_RED, TFT_BLACK);
+    tft.drawString(webServerStarted ? "WIFI LOST" : "WIFI...", tft.width() - 5, 5);
+    tft.setTextDatum(TC_DATUM);
+  }
+
+  // Shot clock from a second console, top left
+  if (serialHandler.hasShotClock()) {
+    tft.setTextDatum(TL_DATUM);
+    tft.setTextColor(serialHandler.isShotClockRunning() ? TFT_GREEN : TFT_LIGHTGREY, TFT_BLACK);
+    char shotLine[12];
+    snprintf(shotLine, sizeof(shotLine), "SHOT %s", shownShot);
+    tft.drawString(shotLine, 5, 5);
+    tft.setTextDatum(TC_DATUM);
+  }
   
   // Display time at the top with larger font
   tft.setTextColor(TFT_YELLOW, TFT_BLACK);
@@ -263,9 +333,10 @@ void displayScoreData() {
   
   // Source info
   tft.setTextColor(TFT_DARKGREY, TFT_BLACK);
-  tft.drawString("Device: " + String(serialHandler.getDeviceType()) + 
-                 "  Channel: " + String(serialHandler.getChannel()),
-                 tft.width()/2, tft.height() - 5);
+  char sourceLine[32];
+  snprintf(sourceLine, sizeof(sourceLine), "Device: %c  Channel: %d",
+           serialHandler.getDeviceType(), serialHandler.getChannel());
+  tft.drawString(sourceLine, tft.width()/2, tft.height() - 5);
 }
 
 bool serverIsRunning() {
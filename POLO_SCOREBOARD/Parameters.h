@@ -0,0 +1,161 @@
+#ifndef PARAMETERS_H
+#define PARAMETERS_H
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include <Preferences.h>
+
+extern Preferences preferences;
+
+// Timings that depend on the console and the site, tunable from the settings page.
+// Every value is read where it is used, so a change applies on the next pass without a reboot.
+enum ParameterId {
+    PARAM_BYTE_TIMEOUT,       // Gap that ends a partial frame
+    PARAM_MAX_MESSAGE_LENGTH, // Longest frame read from the UART
+    PARAM_BAUD_RATES,         // Rates tried by baud detection, a bit per BAUD_RATE_TABLE entry
+    PARAM_BAUD_CHECK,         // How often baud detection runs
+    PARAM_STALE_CHECK,        // How often inputs are checked for a restart
+    PARAM_STALE_TIMEOUT,      // No valid frame for this long restarts an input
+    PARAM_DISPLAY_REFRESH,    // Redraw of the local screen without a change
+    PARAM_HEARTBEAT,          // Resend of unchanged state
+    PARAM_LOOP_WAIT,          // Longest loop() wait while active
+    PARAM_DIM_TIMEOUT,        // Backlight dims after this long with no change
+    PARAM_LOW_POWER_TIMEOUT,  // CPU clocks down after this long with no change
+    PARAM_COUNT
+};
+
+enum ParameterType {
+    PARAM_TYPE_MS,
+    PARAM_TYPE_BYTES,
+    PARAM_TYPE_BAUD_MASK
+};
+
+struct ParameterSpec {
+    const char* name;   // JSON name and Preferences key, 15 characters at most
+    const char* label;
+    ParameterType type;
+    uint32_t defaultValue;
+    uint32_t minValue;
+    uint32_t maxValue;
+};
+
+static const long BAUD_RATE_TABLE[] = {1200, 2400, 4800, 9600, 19200, 38400, 57600, 115200};
+static const int BAUD_RATE_TABLE_SIZE = sizeof(BAUD_RATE_TABLE) / sizeof(BAUD_RATE_TABLE[0]);
+
+// The frame buffer in UartSource is sized for the largest allowed value
+static const uint32_t MESSAGE_LENGTH_LIMIT = 32;
+
+static const char* const PARAMETER_TYPE_NAMES[] = {"ms", "bytes", "baudMask"};
+
+static const ParameterSpec PARAMETER_SPECS[PARAM_COUNT] = {
+    {"byteTimeoutMs",  "Byte timeout",             PARAM_TYPE_MS,        150,    20,    2000},
+    {"maxMessageLen",  "Max frame length",         PARAM_TYPE_BYTES,     18,     14,    MESSAGE_LENGTH_LIMIT},
+    {"baudRates",      "Baud rates to try",        PARAM_TYPE_BAUD_MASK, 0xF8,   1,     0xFF},  // 9600 - 115200
+    {"baudCheckMs",    "Baud check interval",      PARAM_TYPE_MS,        60000,  5000,  600000},
+    {"staleCheckMs",   "Stale input check",        PARAM_TYPE_MS,        300000, 30000, 3600000},
+    {"staleTimeoutMs", "Stale input timeout",      PARAM_TYPE_MS,        180000, 30000, 3600000},
+    {"displayMs",      "Screen refresh interval",  PARAM_TYPE_MS,        5000,   500,   60000},
+    {"heartbeatMs",    "Heartbeat interval",       PARAM_TYPE_MS,        30000,  5000,  300000},
+    {"loopWaitMs",     "Loop wait",                PARAM_TYPE_MS,        10,     1,     100},
+    {"dimMs",          "Backlight dim after",      PARAM_TYPE_MS,        120000, 10000, 3600000},
+    {"lowPowerMs",     "Low power after",          PARAM_TYPE_MS,        300000, 10000, 3600000},
+};
+
+class Parameters {
+private:
+    // Written from the web server task, read from the loop - single 32-bit stores are atomic
+    volatile uint32_t values[PARAM_COUNT];
+
+public:
+    Parameters() {
+        for (int i = 0; i < PARAM_COUNT; i++) values[i] = PARAMETER_SPECS[i].defaultValue;
+    }
+
+    // Call after preferences.begin()
+    void load() {
+        for (int i = 0; i < PARAM_COUNT; i++) {
+            const ParameterSpec& spec = PARAMETER_SPECS[i];
+            values[i] = clamp((ParameterId)i, preferences.getUInt(spec.name, spec.defaultValue));
+        }
+    }
+
+    uint32_t get(ParameterId id) const {
+        return values[id];
+    }
+
+    // Clamps to the parameter's bounds, saves it if it changed and returns what was stored
+    uint32_t set(ParameterId id, uint32_t value) {
+        value = clamp(id, value);
+        if (value != values[id]) {
+            values[id] = value;
+            preferences.putUInt(PARAMETER_SPECS[id].name, value);
+        }
+        return value;
+    }
+
+    void resetAll() {
+        for (int i = 0; i < PARAM_COUNT; i++) {
+            values[i] = PARAMETER_SPECS[i].defaultValue;
+            preferences.remove(PARAMETER_SPECS[i].name);
+        }
+    }
+
+    static uint32_t clamp(ParameterId id, uint32_t value) {
+        const ParameterSpec& spec = PARAMETER_SPECS[id];
+        if (value < spec.minValue) return spec.minValue;
+        if (value > spec.maxValue) return spec.maxValue;
+        return value;
+    }
+
+    // -1 if not a parameter name
+    static int find(const char* name) {
+        for (int i = 0; i < PARAM_COUNT; i++) {
+            if (strcmp(PARAMETER_SPECS[i].name, name) == 0) return i;
+        }
+        return -1;
+    }
+
+    // Every parameter with its bounds, so the settings page can build its form from this
+    void toJson(JsonArray list) const {
+        for (int i = 0; i < PARAM_COUNT; i++) {
+            const ParameterSpec& spec = PARAMETER_SPECS[i];
+            JsonObject entry = list.createNestedObject();
+            entry["name"] = spec.name;
+            entry["label"] = spec.label;
+            entry["type"] = PARAMETER_TYPE_NAMES[spec.type];
+            entry["value"] = values[i];
+            entry["default"] = spec.defaultValue;
+            entry["min"] = spec.minValue;
+            entry["max"] = spec.maxValue;
+            if (spec.type == PARAM_TYPE_BAUD_MASK) {
+                JsonArray rates = entry.createNestedArray("rates");
+                for (int rate = 0; rate < BAUD_RATE_TABLE_SIZE; rate++) rates.add(BAUD_RATE_TABLE[rate]);
+            }
+        }
+    }
+
+    bool isBaudEnabled(int index) const {
+        return (get(PARAM_BAUD_RATES) >> index) & 1;
+    }
+
+    // Lowest enabled baud rate, where detection starts
+    int firstBaudIndex() const {
+        for (int i = 0; i < BAUD_RATE_TABLE_SIZE; i++) {
+            if (isBaudEnabled(i)) return i;
+        }
+        return 0;
+    }
+
+    // Next enabled baud rate after index, wrapping round
+    int nextBaudIndex(int index) const {
+        for (int step = 1; step <= BAUD_RATE_TABLE_SIZE; step++) {
+            int next = (index + step) % BAUD_RATE_TABLE_SIZE;
+            if (isBaudEnabled(next)) return next;
+        }
+        return index;
+    }
+};
+
+extern Parameters parameters;
+
+#endif // PARAMETERS_H
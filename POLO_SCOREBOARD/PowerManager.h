@@ -0,0 +1,137 @@
+#ifndef POWER_MANAGER_H
+#define POWER_MANAGER_H
+
+#include <Arduino.h>
+#include <WiFi.h>
+#include "LoopWake.h"
+#include "Parameters.h"
+
+#if CONFIG_PM_ENABLE
+#include "esp_pm.h"
+#include "esp_sleep.h"
+#include "driver/gpio.h"
+#include "driver/uart.h"
+#endif
+
+// T-Display S3 backlight pin
+#ifndef TFT_BL
+#define TFT_BL 38
+#endif
+
+// Idle handling for battery-powered bridges:
+//  - loop() blocks until a button edge, UART frame or timeout instead of spinning every 10 ms
+//  - the backlight dims when the score hasn't changed for a while
+//  - after longer with no changes the CPU clocks down, and when the UART is silent too
+//    the chip light-sleeps between events (needs a core built with CONFIG_PM_ENABLE)
+class PowerManager {
+private:
+    // Configuration - the dim and low power timeouts and the active wait are parameters
+    static const uint8_t BACKLIGHT_CHANNEL = 0;             // LEDC channel for the backlight PWM
+    static const uint8_t FULL_BRIGHTNESS = 255;
+    static const uint8_t DIM_BRIGHTNESS = 20;
+    static const unsigned long UART_SILENT_TIME = 30000;    // Light sleep only once the console stops sending
+    static const uint32_t IDLE_WAIT_MS = 250;               // Timers still run, wake-ups cut this short
+    static const uint32_t ACTIVE_CPU_MHZ = 240;
+    static const uint32_t LOW_POWER_CPU_MHZ = 80;           // Lowest clock that keeps APB and the UART baud intact
+
+    unsigned long lastActivity = 0;
+    bool dimmed = false;
+    bool lowPower = false;
+    bool lightSleep = false;
+
+    void setBacklight(uint8_t level) {
+        ledcWrite(BACKLIGHT_CHANNEL, level);
+    }
+
+    void setLowPower(bool enable) {
+        if (enable == lowPower) return;
+        lowPower = enable;
+#if !CONFIG_PM_ENABLE
+        // Without the power management driver, scale the clock by hand
+        setCpuFrequencyMhz(enable ? LOW_POWER_CPU_MHZ : ACTIVE_CPU_MHZ);
+#endif
+        configureSleep();
+    }
+
+    void configureSleep() {
+#if CONFIG_PM_ENABLE
+        // The idle task light-sleeps whenever every task is blocked,
+        // which is most of the time once loop() waits on a notification
+#if ESP_IDF_VERSION_MAJOR >= 5
+        esp_pm_config_t config;
+#else
+        esp_pm_config_esp32s3_t config;
+#endif
+        config.max_freq_mhz = lowPower ? LOW_POWER_CPU_MHZ : ACTIVE_CPU_MHZ;
+        config.min_freq_mhz = LOW_POWER_CPU_MHZ;
+        config.light_sleep_enable = lightSleep;
+        esp_pm_configure(&config);
+#endif
+    }
+
+public:
+    PowerManager() {}
+
+    void begin() {
+        // Drive the backlight through PWM so it can be dimmed
+        ledcSetup(BACKLIGHT_CHANNEL, 5000, 8);
+        ledcAttachPin(TFT_BL, BACKLIGHT_CHANNEL);
+        setBacklight(FULL_BRIGHTNESS);
+
+#if CONFIG_PM_ENABLE
+        // Wake sources for light sleep: UART RX edges and either button
+        uart_set_wakeup_threshold(UART_NUM_1, 3);
+        esp_sleep_enable_uart_wakeup(UART_NUM_1);
+        gpio_wakeup_enable(GPIO_NUM_0, GPIO_INTR_LOW_LEVEL);
+        gpio_wakeup_enable(GPIO_NUM_14, GPIO_INTR_LOW_LEVEL);
+        esp_sleep_enable_gpio_wakeup();
+#endif
+        configureSleep();
+
+        lastActivity = millis();
+    }
+
+    // A state change or button press - back to full brightness and full speed
+    void noteActivity() {
+        lastActivity = millis();
+        if (dimmed) {
+            setBacklight(FULL_BRIGHTNESS);
+            dimmed = false;
+        }
+        setLowPower(false);
+    }
+
+    // sleepAllowed: false while an input that can't wake the chip is in use
+    void update(unsigned long lastUartByteTime, bool sleepAllowed) {
+        unsigned long now = millis();
+        unsigned long idleFor = now - lastActivity;
+
+        if (!dimmed && idleFor >= parameters.get(PARAM_DIM_TIMEOUT)) {
+            setBacklight(DIM_BRIGHTNESS);
+            dimmed = true;
+        }
+        if (!lowPower && idleFor >= parameters.get(PARAM_LOW_POWER_TIMEOUT)) {
+            setLowPower(true);
+        }
+
+        // A frame that wakes the chip from light sleep loses its first bytes,
+        // so only sleep while the console is not sending at all
+        bool sleep = sleepAllowed && lowPower && (now - lastUartByteTime >= UART_SILENT_TIME);
+        if (sleep != lightSleep) {
+            lightSleep = sleep;
+            configureSleep();
+        }
+    }
+
+    // Replaces the fixed loop delay. Returns as soon as a button edge or UART frame arrives.
+    void wait(bool busy) {
+        waitForWake((lowPower && !busy) ? IDLE_WAIT_MS : parameters.get(PARAM_LOOP_WAIT));
+    }
+
+    bool isDimmed() const { return dimmed; }
+    bool isLowPower() const { return lowPower; }
+};
+
+extern PowerManager powerManager;
+
+#endif // POWER_MANAGER_H
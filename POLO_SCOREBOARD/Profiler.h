@@ -0,0 +1,325 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include <ESPAsyncWebServer.h>
+#include <esp_debug_helpers.h>
+#include <esp_freertos_hooks.h>
+#include <esp_heap_caps.h>
+#include <esp_idf_version.h>
+
+// Where the CPU goes on a live bridge, without a debugger:
+//   /profile         CPU per task and per core since the last request, stack high-water marks
+//   /profile/stacks  a PC sampler driven by the FreeRTOS tick on both cores, as folded stacks
+// The stacks are raw addresses; scoreboard_symbolize in POLO_SCOREBOARD_LINUX turns them
+// into function names with the firmware ELF, ready for flamegraph.pl.
+
+#if ESP_IDF_VERSION_MAJOR >= 5
+#define profilerIdleTask(core) xTaskGetIdleTaskHandleForCore(core)
+#else
+#define profilerIdleTask(core) xTaskGetIdleTaskHandleForCPU(core)
+#endif
+
+// First words of the FreeRTOS XtExcFrame the interrupted task's registers are saved in
+struct ProfilerExcFrame {
+    uint32_t exit;
+    uint32_t pc;
+    uint32_t ps;
+    uint32_t a0;
+    uint32_t a1;
+};
+
+class Profiler {
+private:
+    static const uint8_t MAX_DEPTH = 12;
+    static const uint16_t SLOTS = 256;        // Distinct stacks kept, a power of two
+    static const uint8_t MAX_TASKS = 32;      // Tracked for CPU use between reports
+    static const uint32_t DEFAULT_HZ = 100;   // Per core
+    static const uint32_t MAX_HZ = 1000;      // The tick rate
+
+    struct Stack {
+        uint32_t hash;
+        uint32_t count;       // 0 marks a free slot
+        TaskHandle_t task;
+        uint8_t depth;
+        uint32_t pcs[MAX_DEPTH]; // Leaf first
+    };
+
+    // The table lives in internal RAM: the tick hook also runs while the flash cache is off
+    Stack* stacks = nullptr;
+    volatile bool sampling = false;
+    volatile bool paused = false;  // Set while /profile/stacks reads the table
+    uint32_t tickDivider = 1000 / DEFAULT_HZ;
+    uint32_t ticks[portNUM_PROCESSORS] = {};
+    uint32_t samples = 0;
+    uint32_t dropped = 0;          // Table full or paused
+    unsigned long startedMs = 0;
+    portMUX_TYPE lock = portMUX_INITIALIZER_UNLOCKED;
+
+    // Run time of every task at the previous /profile, for CPU use since then
+    struct TaskRunTime {
+        TaskHandle_t handle;
+        uint32_t runTime;
+    };
+    TaskRunTime previousTasks[MAX_TASKS];
+    uint8_t previousTaskCount = 0;
+    uint32_t previousTotal = 0;
+
+    static void tickHook();
+
+    // Windowed call return addresses carry the call size in the top bits
+    static inline uint32_t IRAM_ATTR realPc(uint32_t pc) {
+        if (pc & 0x80000000) pc = (pc & 0x3fffffff) | 0x40000000;
+        return pc - 3;
+    }
+
+    // Tick interrupt on each core: walks the stack of the task it interrupted
+    void IRAM_ATTR sample() {
+        uint8_t core = xPortGetCoreID();
+        if (++ticks[core] < tickDivider) return;
+        ticks[core] = 0;
+
+        // The interrupt entry saved the task's registers where its TCB's first word points
+        TaskHandle_t task = xTaskGetCurrentTaskHandle();
+        const ProfilerExcFrame* saved = *(const ProfilerExcFrame* const*)task;
+        if (saved == nullptr) return;
+
+        uint32_t pcs[MAX_DEPTH];
+        uint8_t depth = 0;
+        esp_backtrace_frame_t frame = {saved->pc, saved->a1, saved->a0};
+        pcs[depth++] = frame.pc;
+        while (depth < MAX_DEPTH && frame.next_pc != 0 && esp_backtrace_get_next_frame(&frame)) {
+            pcs[depth++] = realPc(frame.pc);
+        }
+
+        uint32_t hash = 2166136261u ^ (uint32_t)(uintptr_t)task;
+        for (uint8_t i = 0; i < depth; i++) hash = (hash ^ pcs[i]) * 16777619u;
+
+        portENTER_CRITICAL_ISR(&lock);
+        if (paused) {
+            dropped++;
+            portEXIT_CRITICAL_ISR(&lock);
+            return;
+        }
+        samples++;
+        for (uint16_t probe = 0; probe < SLOTS; probe++) {
+            Stack& slot = stacks[(hash + probe) & (SLOTS - 1)];
+            if (slot.count == 0) {
+                slot.hash = hash;
+                slot.count = 1;
+                slot.task = task;
+                slot.depth = depth;
+                memcpy(slot.pcs, pcs, depth * sizeof(uint32_t));
+                portEXIT_CRITICAL_ISR(&lock);
+                return;
+            }
+            if (slot.hash == hash && slot.task == task && slot.depth == depth &&
+                memcmp(slot.pcs, pcs, depth * sizeof(uint32_t)) == 0) {
+                slot.count++;
+                portEXIT_CRITICAL_ISR(&lock);
+                return;
+            }
+        }
+        samples--;
+        dropped++;
+        portEXIT_CRITICAL_ISR(&lock);
+    }
+
+    // Every task with its run time, to be freed by the caller. count is 0 without FreeRTOS trace support.
+    static TaskStatus_t* getTasks(UBaseType_t& count, uint32_t& totalRunTime) {
+        count = 0;
+        totalRunTime = 0;
+#if configUSE_TRACE_FACILITY
+        UBaseType_t capacity = uxTaskGetNumberOfTasks() + 2; // Room for tasks started meanwhile
+        TaskStatus_t* tasks = (TaskStatus_t*)malloc(capacity * sizeof(TaskStatus_t));
+        if (tasks != nullptr) count = uxTaskGetSystemState(tasks, capacity, &totalRunTime);
+        return tasks;
+#else
+        return nullptr;
+#endif
+    }
+
+    static const char* taskName(TaskHandle_t handle, const TaskStatus_t* tasks, UBaseType_t count) {
+        for (UBaseType_t i = 0; i < count; i++) {
+            if (tasks[i].xHandle == handle) return tasks[i].pcTaskName;
+        }
+        return "exited";
+    }
+
+public:
+    Profiler() {}
+
+    bool isSampling() const { return sampling; }
+
+    // Clears the table and starts sampling at hz per core
+    bool start(uint32_t hz) {
+        if (hz == 0) hz = DEFAULT_HZ;
+        if (hz > MAX_HZ) hz = MAX_HZ;
+        stop();
+        if (stacks == nullptr) {
+            stacks = (Stack*)heap_caps_malloc(SLOTS * sizeof(Stack), MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+            if (stacks == nullptr) return false;
+        }
+        memset(stacks, 0, SLOTS * sizeof(Stack));
+        tickDivider = MAX_HZ / hz;
+        samples = 0;
+        dropped = 0;
+        paused = false;
+        startedMs = millis();
+        sampling = true;
+        for (uint8_t core = 0; core < portNUM_PROCESSORS; core++) {
+            esp_register_freertos_tick_hook_for_cpu(tickHook, core);
+        }
+        return true;
+    }
+
+    // The table is kept for /profile/stacks until the next start
+    void stop() {
+        if (!sampling) return;
+        for (uint8_t core = 0; core < portNUM_PROCESSORS; core++) {
+            esp_deregister_freertos_tick_hook_for_cpu(tickHook, core);
+        }
+        sampling = false;
+    }
+
+    // CPU per task and per core since the previous call, and each task's smallest free stack
+    String getTaskReport() {
+        UBaseType_t count;
+        uint32_t total;
+        TaskStatus_t* tasks = getTasks(count, total);
+
+        DynamicJsonDocument doc(6144);
+        doc["uptimeMs"] = millis();
+        doc["freeHeap"] = ESP.getFreeHeap();
+        doc["minFreeHeap"] = ESP.getMinFreeHeap();
+        if (count == 0) {
+            doc["status"] = "FreeRTOS trace facility not enabled";
+        }
+
+        // The run time counter is per core wall time, so 100% is one core fully busy
+        uint32_t elapsed = total - previousTotal;
+        doc["intervalUs"] = elapsed;
+        JsonArray cores = doc.createNestedArray("cores");
+        JsonArray list = doc.createNestedArray("tasks");
+        TaskRunTime current[MAX_TASKS];
+        for (UBaseType_t i = 0; i < count; i++) {
+            const TaskStatus_t& task = tasks[i];
+            uint32_t before = 0;
+            for (uint8_t j = 0; j < previousTaskCount; j++) {
+                if (previousTasks[j].handle == task.xHandle) before = previousTasks[j].runTime;
+            }
+            if (i < MAX_TASKS) {
+                current[i].handle = task.xHandle;
+                current[i].runTime = task.ulRunTimeCounter;
+            }
+
+            JsonObject entry = list.createNestedObject();
+            entry["name"] = task.pcTaskName;
+            entry["priority"] = task.uxCurrentPriority;
+#if configTASKLIST_INCLUDE_COREID
+            if (task.xCoreID < portNUM_PROCESSORS) entry["core"] = task.xCoreID;
+            else entry["core"] = "any";
+#endif
+#if configGENERATE_RUN_TIME_STATS
+            if (elapsed > 0) entry["cpu"] = 100.0f * (task.ulRunTimeCounter - before) / elapsed;
+#endif
+            entry["stackFreeMin"] = task.usStackHighWaterMark; // Bytes on the ESP32
+        }
+
+#if configGENERATE_RUN_TIME_STATS
+        // A core's load is whatever its idle task didn't get
+        for (uint8_t core = 0; core < portNUM_PROCESSORS && elapsed > 0; core++) {
+            TaskHandle_t idle = profilerIdleTask(core);
+            for (UBaseType_t i = 0; i < count; i++) {
+                if (tasks[i].xHandle != idle) continue;
+                uint32_t before = 0;
+                for (uint8_t j = 0; j < previousTaskCount; j++) {
+                    if (previousTasks[j].handle == idle) before = previousTasks[j].runTime;
+                }
+                JsonObject entry = cores.createNestedObject();
+                entry["core"] = core;
+                entry["load"] = 100.0f - 100.0f * (tasks[i].ulRunTimeCounter - before) / elapsed;
+            }
+        }
+#endif
+        previousTaskCount = count < MAX_TASKS ? count : MAX_TASKS;
+        memcpy(previousTasks, current, previousTaskCount * sizeof(TaskRunTime));
+        previousTotal = total;
+
+        JsonObject sampler = doc.createNestedObject("sampler");
+        sampler["sampling"] = sampling;
+        sampler["hz"] = MAX_HZ / tickDivider;
+        sampler["samples"] = samples;
+        sampler["dropped"] = dropped;
+        if (startedMs != 0) sampler["ageMs"] = millis() - startedMs;
+
+        free(tasks);
+        String json;
+        serializeJson(doc, json);
+        return json;
+    }
+
+    // Folded stacks, one line per distinct stack: task;outermost;...;leaf count
+    void printStacks(Print& out) {
+        if (stacks == nullptr) return;
+        UBaseType_t count;
+        uint32_t total;
+        TaskStatus_t* tasks = getTasks(count, total);
+
+        // Sampling carries on, samples taken while the table is read are counted as dropped
+        portENTER_CRITICAL(&lock);
+        paused = true;
+        portEXIT_CRITICAL(&lock);
+
+        for (uint16_t i = 0; i < SLOTS; i++) {
+            const Stack& stack = stacks[i];
+            if (stack.count == 0) continue;
+            out.print(taskName(stack.task, tasks, count));
+            for (int frame = stack.depth - 1; frame >= 0; frame--) {
+                out.printf(";0x%08lx", (unsigned long)stack.pcs[frame]);
+            }
+            out.printf(" %lu\n", (unsigned long)stack.count);
+        }
+
+        portENTER_CRITICAL(&lock);
+        paused = false;
+        portEXIT_CRITICAL(&lock);
+        free(tasks);
+    }
+};
+
+extern Profiler profiler;
+
+void IRAM_ATTR Profiler::tickHook() {
+    profiler.sample();
+}
+
+// Used by the /profile routes in WebRoutes.h
+String getProfileReport() {
+    return profiler.getTaskReport();
+}
+
+void handleProfileStacksRequest(AsyncWebServerRequest* request) {
+    if (request->hasParam("start")) {
+        uint32_t hz = request->hasParam("hz") ? request->getParam("hz")->value().toInt() : 0;
+        if (!profiler.start(hz)) {
+            request->send(503, "application/json", "{\"status\":\"no memory for the sample table\"}");
+            return;
+        }
+        request->send(202, "application/json", "{\"status\":\"sampling\"}");
+        return;
+    }
+    if (request->hasParam("stop")) {
+        profiler.stop();
+        request->send(200, "application/json", "{\"status\":\"stopped\"}");
+        return;
+    }
+
+    AsyncResponseStream* response = request->beginResponseStream("text/plain");
+    response->addHeader("Content-Disposition", "attachment; filename=\"scoreboard.folded\"");
+    profiler.printStacks(*response);
+    request->send(response);
+}
+
+#endif // PROFILER_H
@@ -15,215 +15,217 @@
 #include "WebSocketSetup.h"
 #include <ArduinoJson.h>
 #include "DisplaySetup.h"
+#include "BroadcastRate.h"
+#include "MulticastPublisher.h"
+#include "LoopWake.h"
+#include "FrameDecoder.h"
+#include "StateJson.h"
+#include "LatencyTracker.h"
+#include "UartSource.h"
+#include "EventStream.h"
+#include "StatePipeline.h"
+#include "StateSnapshot.h"
+#include "StateRestore.h"
 
 extern AsyncWebSocket ws;
 
-class SerialHandler {
+// Second console input, e.g. a separate shot clock controller. Its role is set on the settings page.
+#ifndef SECOND_UART_RX_PIN
+#define SECOND_UART_RX_PIN 18
+#endif
+#ifndef SECOND_UART_TX_PIN
+#define SECOND_UART_TX_PIN 17
+#endif
+
+class SerialHandler : private StatePipelineOutput {
 private:
-    static const int MAX_MESSAGE_LENGTH = 18;
-    char message[MAX_MESSAGE_LENGTH];
-    unsigned int message_pos = 0;
     bool debug = false;
 
-    // Modified: Longer timeout to ensure complete messages
-    static const unsigned long BYTE_TIMEOUT = 150; // ms between bytes
-    bool lookingForStart = false; // Changed to false to accept any data initially
-    unsigned long lastByteTime = 0;
-    unsigned long lastValidDataTime = 0;
-
-    struct ScoreData {
-        char timeFormatted[6] = "00:00";
-        char homeScore[3] = "00";
-        char awayScore[3] = "00";
-        int channel = 0;
-    } scoreData, previousData;
-    
-    // Device status indicators
-    char deviceType = 'D';      // 'D' or 'T'
-    char deviceNumber = '0';    // Number after device type
-
-    
-
-    bool isDataValid() {
-        // Check that time is properly formatted
-        if (strlen(scoreData.timeFormatted) != 5) return false;
-        if (scoreData.timeFormatted[2] != ':') return false;
-        
-        if (!isDigit(scoreData.timeFormatted[0]) || 
-            !isDigit(scoreData.timeFormatted[1]) || 
-            !isDigit(scoreData.timeFormatted[3]) || 
-            !isDigit(scoreData.timeFormatted[4])) {
+    // Console inputs: the main console on Serial1 and an optional second one on Serial2
+    static const uint8_t SOURCE_COUNT = 2;
+    static const unsigned long FAILOVER_TIMEOUT = 3000; // Main console silent this long: use the backup
+    UartSource mainSource{Serial1, "main", 19, 20, SOURCE_MAIN};
+    UartSource secondSource{Serial2, "second", SECOND_UART_RX_PIN, SECOND_UART_TX_PIN, SOURCE_DISABLED};
+    UartSource* sources[SOURCE_COUNT] = {&mainSource, &secondSource};
+    UartSource* clockSource = &mainSource; // Feeds the game clock and scores
+
+    // Merged state: game clock and scores from clockSource, including the device status indicators.
+    // The pipeline keeps it, along with the state sequence.
+    StatePipelineState pipeline;
+    ScoreFrame& scoreData = pipeline.current;
+
+    // Shot clock from a second console in the shot clock role
+    struct ShotClock {
+        char time[6] = "00:00";
+        bool running = false;
+        bool present = false;
+    } shotClock;
+
+    // Decides when state changes actually go out
+    BroadcastRateController broadcastRate;
+
+    // Incremented each time a changed state is published, heartbeats repeat the last value
+    uint32_t& stateSequence = pipeline.sequence;
+
+    // Set from the async_tcp task when a page asks for the state, sent from the loop
+    volatile bool currentStateRequested = false;
+
+    // The broadcast slot being sent: when it started and whether it is a catch-up
+    uint32_t slotUs = 0;
+    bool slotCatchUp = false;
+
+    // Counts accepted state changes, including ones made while offline
+    unsigned long stateChanges = 0;
+
+    // Latency tracing, all micros(): when the latest change arrived and was decoded.
+    // The arrival stamp goes out as "ts"; each part of the state also keeps its own.
+    uint32_t changeArrivalUs = 0;
+    uint32_t changeDecodedUs = 0;
+    uint32_t clockArrivalUs = 0;
+    uint32_t shotArrivalUs = 0;
+
+    // While the network is down changes are still decoded and recorded, then sent as one catch-up
+    bool networkOnline = false;
+    unsigned long outageStart = 0;
+    unsigned long outageChanges = 0;
+    unsigned long outageScoreChanges = 0;
+
+    bool isFrameValid(const ScoreFrame& frame) {
+        if (!isScoreFrameTimeValid(frame)) {
             if (debug) debugWS("Invalid time format");
             return false;
         }
-        
-        // Check that scores are digits
-        if (strlen(scoreData.homeScore) != 2 || strlen(scoreData.awayScore) != 2) return false;
-        
-        if (!isDigit(scoreData.homeScore[0]) || !isDigit(scoreData.homeScore[1]) ||
-            !isDigit(scoreData.awayScore[0]) || !isDigit(scoreData.awayScore[1])) {
+        if (!isScoreFrameScoreValid(frame)) {
             if (debug) debugWS("Invalid score format");
             return false;
         }
-        
         return true;
     }
 
-    void clearBuffer() {
-        message_pos = 0;
-        memset(message, 0, MAX_MESSAGE_LENGTH);
-    }
-
-    bool isDigit(char c) {
-        return c >= '0' && c <= '9';
+    bool hasSecondSource() const {
+        return secondSource.getRole() != SOURCE_DISABLED;
     }
 
-    bool isSpace(char c) {
-        return c == ' ' || c == '\t';
+    // Debug lines name the console once there is more than one
+    String sourceTag(const UartSource& source) const {
+        return hasSecondSource() ? "[" + String(source.getName()) + "] " : String();
     }
 
     // Enhanced parsing method specifically for the observed format: �1D21200990401
-    void parseMessageFormat() {
-        // Build debugging info for WebSocket
-        String hexOutput = "Raw hex: ";
-        String asciiOutput = "Raw ASCII: ";
-        for (int i = 0; i < message_pos; i++) {
-            char buf[5];
-            snprintf(buf, sizeof(buf), "%02X ", (unsigned char)message[i]);
-            hexOutput += buf;
-            
-            if (message[i] >= 32 && message[i] <= 126) {
-                asciiOutput += message[i];
-            } else {
-                asciiOutput += ".";
-            }
-        }
-        
+    // Decodes into frame, which starts out as the source's last good frame. Returns true for a valid frame.
+    bool parseMessageFormat(UartSource& source, ScoreFrame& frame) {
+        const char* message = source.getMessage();
+        int length = source.getMessageLength();
+        String tag = debug ? sourceTag(source) : String();
+
+        // Raw dump for the debug page, only built when debug mode is on
         if (debug) {
-            debugWS(hexOutput);
-            debugWS(asciiOutput);
+            char hexOutput[10 + 3 * UartSource::MAX_MESSAGE_LENGTH];
+            char asciiOutput[12 + UartSource::MAX_MESSAGE_LENGTH];
+            formatRawFrame(message, length, hexOutput, sizeof(hexOutput), asciiOutput, sizeof(asciiOutput));
+            debugWS(tag + hexOutput);
+            debugWS(tag + asciiOutput);
         }
         
-        // More aggressive pattern search - specifically for format: �1D21200990401
         int dataStart = -1;
-        
-        // First, try the format where digit is followed directly by D or T
-        for (int i = 0; i < message_pos - 1; i++) {
-            if (isDigit(message[i]) && (message[i+1] == 'D' || message[i+1] == 'T')) {
-                dataStart = i;
-                if (debug) debugWS("Standard pattern found at position " + String(dataStart));
-                break;
-            }
-        }
-        
-        // If that fails, try looking for control character followed by digit then D or T
-        if (dataStart == -1) {
-            for (int i = 0; i < message_pos - 2; i++) {
-                if (message[i] < 32 && isDigit(message[i+1]) && 
-                (message[i+2] == 'D' || message[i+2] == 'T')) {
-                    dataStart = i + 1; // Skip control char
-                    if (debug) debugWS("Control+digit+D/T pattern found at position " + String(dataStart));
-                    break;
-                }
-            }
-        }
+        FrameDecodeResult result = decodeScoreFrame(message, length, frame, &dataStart);
         
         // Couldn't find the pattern
-        if (dataStart == -1) {
-            if (debug) debugWS("No pattern found");
-            return;
+        if (result == FRAME_NO_PATTERN) {
+            if (debug) debugWS(tag + "No pattern found");
+            return false;
         }
-        
-        // Extract components based on the known format
-        scoreData.channel = message[dataStart] - '0';
-        deviceType = message[dataStart + 1];
-        deviceNumber = message[dataStart + 2]; // Get number after T/D
+        if (debug) debugWS(tag + "Pattern found at position " + String(dataStart));
         
         // Need enough characters after dataStart
-        if (dataStart + 13 >= message_pos) {
-            if (debug) debugWS("Message too short after pattern");
-            return;
-        }
-        
-        // Minutes (positions 3-4 after dataStart)
-        char minutes[3] = {message[dataStart + 3], message[dataStart + 4], '\0'};
-        
-        // Seconds (positions 5-6 after dataStart)
-        char seconds[3] = {message[dataStart + 5], message[dataStart + 6], '\0'};
-        
-        // Format time
-        snprintf(scoreData.timeFormatted, sizeof(scoreData.timeFormatted), "%s:%s", minutes, seconds);
-        
-        // Skip the milliseconds (positions 7-9)
-        
-        // Home score (positions 10-11)
-        scoreData.homeScore[0] = message[dataStart + 9];
-        scoreData.homeScore[1] = message[dataStart + 10];
-        scoreData.homeScore[2] = '\0';
-        
-        // Away score (positions 12-13)
-        if (dataStart + 12 < message_pos) {
-            scoreData.awayScore[0] = message[dataStart + 11];
-            scoreData.awayScore[1] = message[dataStart + 12];
-            scoreData.awayScore[2] = '\0';
+        if (result == FRAME_TOO_SHORT) {
+            if (debug) debugWS(tag + "Message too short after pattern");
+            return false;
         }
         
         if (debug) {
-            String msgInfo = "Parsed - Channel: " + String(scoreData.channel) + 
-                        ", Type: " + String(deviceType) + String(deviceNumber) + 
-                        ", Time: " + String(scoreData.timeFormatted) + 
-                        ", Home: " + String(scoreData.homeScore) + 
-                        ", Away: " + String(scoreData.awayScore);
+            String msgInfo = tag + "Parsed - Channel: " + String(frame.channel) + 
+                        ", Type: " + String(frame.deviceType) + String(frame.deviceNumber) + 
+                        ", Time: " + String(frame.timeFormatted) + 
+                        ", Home: " + String(frame.homeScore) + 
+                        ", Away: " + String(frame.awayScore);
             debugWS(msgInfo);
         }
-    }
 
-    bool hasDataChanged() {
-        bool changed = strcmp(scoreData.timeFormatted, previousData.timeFormatted) != 0 ||
-                      strcmp(scoreData.homeScore, previousData.homeScore) != 0 ||
-                      strcmp(scoreData.awayScore, previousData.awayScore) != 0 ||
-                      scoreData.channel != previousData.channel;
-                      
-        
-        if (changed && debug) {
-            debugWS("Data changed detected");
+        if (!isFrameValid(frame)) {
+            if (debug) debugWS(tag + "Invalid data detected - update skipped");
+            return false;
         }
-        
-        return changed;
+        return true;
     }
 
-    void updatePreviousState() {
-        strcpy(previousData.timeFormatted, scoreData.timeFormatted);
-        strcpy(previousData.homeScore, scoreData.homeScore);
-        strcpy(previousData.awayScore, scoreData.awayScore);
-        previousData.channel = scoreData.channel;
+    // StatePipelineOutput, called from runStatePipeline() and broadcastState() on the loop task
+    void stateChanged(const StatePipelineState& state, uint32_t arrivalUs) override {
+        if (debug) debugWS("Data changed detected");
+        GamePhase phase = BroadcastRateController::phaseFor(state.current.deviceType == 'T', state.current.timeFormatted);
+        bool scoreChanged = hasScoreFrameScoreChanged(state.current, state.previous);
+        clockArrivalUs = arrivalUs;
+        recordChange(phase, scoreChanged, scoreChanged, clockArrivalUs);
+        stateRestore.noteFrame(state.current);
     }
 
-    void sendWebSocketUpdate() {
-        // Only send data if it's valid
-        if (!isDataValid()) {
-            if (debug) debugWS("Data validation failed - not sending WebSocket update");
-            return;
+    // Goals, clock start/stop and the rest, for consumers of /events
+    void gameEvent(GameEvent& event) override {
+        gameEventStream.publish(event);
+        if (debug) debugWS(String("Game event: ") + GAME_EVENT_NAMES[event.type]);
+    }
+
+    bool isBroadcastDue(bool& newState) override {
+        // Nothing can go out during an outage; pending changes coalesce until the link returns
+        if (!networkOnline) return false;
+
+        unsigned long currentMillis = millis();
+        bool requested = currentStateRequested;
+        currentStateRequested = false;
+        if (!requested && !broadcastRate.isDue(currentMillis)) return false;
+        if (requested && debug) debugWS("Current state sent to client");
+
+        newState = broadcastRate.isPending();
+        slotCatchUp = broadcastRate.isForced();
+        slotUs = micros();
+        broadcastRate.markSent(currentMillis);
+        return true;
+    }
+
+    void describeState(StateJsonFields& fields, StatePacket& packet) override {
+        fields.arrivalUs = changeArrivalUs;
+        fields.sentUs = micros(); // Send time, synced pages show the update at bt + playout
+        if (hasSecondSource()) {
+            fields.clockSource = clockSource->getName();
+            fields.clockUs = clockArrivalUs;
+        }
+        if (shotClock.present) {
+            fields.shotClock = shotClock.time;
+            fields.shotRunning = shotClock.running;
+            fields.shotUs = shotArrivalUs;
         }
-        
-        if (ws.count() > 0) {
-            // Continue with the existing WebSocket code
-            StaticJsonDocument<200> doc;
-            doc["time"] = scoreData.timeFormatted;
-            doc["home"] = scoreData.homeScore;
-            doc["away"] = scoreData.awayScore;
-            doc["deviceType"] = String(deviceType) + String(deviceNumber);
-            doc["channel"] = scoreData.channel;
-            doc["isRunning"] = (deviceType == 'T');
-            doc["source"] = "scoreboard";
 
-            String jsonString;
-            serializeJson(doc, jsonString);
+        packet.phase = (uint8_t)broadcastRate.getPhase();
+        if (clockSource->getRole() == SOURCE_BACKUP) packet.flags |= STATE_FLAG_BACKUP;
+        if (shotClock.present) {
+            packet.shotMinutes = (uint8_t)twoDigitValue(shotClock.time);
+            packet.shotSeconds = (uint8_t)twoDigitValue(shotClock.time + 3);
+            packet.shotFlags = SHOT_FLAG_PRESENT | (shotClock.running ? SHOT_FLAG_RUNNING : 0);
+        }
+    }
 
+    void sendState(const char* json, size_t length, const StatePacket& packet, bool newState) override {
+        // The /api/state copy is kept even with no WebSocket clients
+        if (newState) {
+            stateSnapshot.publish(json, length, stateSequence);
+            stateRestore.noteSequence(stateSequence);
+        }
+        if (!networkOnline) return; // A restored state before Wi-Fi is up only goes to /api/state
+        if (ws.count() > 0) {
             try {
-                ws.textAll(jsonString);
+                ws.textAll(json, length);
                 if (debug) {
-                    debugWS("WS sent: " + jsonString);
+                    debugWS(String("WS sent: ") + json);
                 }
             } catch (...) {
                 if (debug) {
@@ -231,55 +233,188 @@ private:
                 }
             }
         }
+        multicastPublisher.publish(packet);
+
+        // Heartbeats repeat an old stamp, and a catch-up after an outage would swamp the queue stage
+        if (newState && !slotCatchUp) {
+            uint32_t sentUs = micros();
+            latencyTracker.recordStage(LATENCY_QUEUE, slotUs - changeDecodedUs);
+            latencyTracker.recordStage(LATENCY_SEND, sentUs - slotUs);
+            latencyTracker.recordSent(stateSequence, changeArrivalUs, sentUs);
+        }
+    }
+
+    // Bookkeeping shared by every kind of state change
+    void recordChange(GamePhase phase, bool urgent, bool scoreChanged, uint32_t arrivalUs) {
+        broadcastRate.markChanged(phase, urgent);
+        stateChanges++;
+        changeArrivalUs = arrivalUs;
+        changeDecodedUs = micros();
+        latencyTracker.recordStage(LATENCY_INGEST, changeDecodedUs - changeArrivalUs);
+        if (!networkOnline) {
+            outageChanges++;
+            if (scoreChanged) outageScoreChanges++;
+        }
+    }
+
+    // The main console feeds the game clock unless it has gone quiet and a backup is live
+    void selectClockSource() {
+        UartSource* preferred = &mainSource;
+        if (!mainSource.hasReceivedValidData(FAILOVER_TIMEOUT) && secondSource.getRole() == SOURCE_BACKUP &&
+            secondSource.hasReceivedValidData(FAILOVER_TIMEOUT)) {
+            preferred = &secondSource;
+        }
+        if (preferred != clockSource) {
+            clockSource = preferred;
+            if (debug) debugWS("Game clock source: " + String(clockSource->getName()));
+        }
+    }
+
+    void mergeGameClock(UartSource& source) {
+        selectClockSource();
+        if (&source != clockSource) return; // Backup frames are ignored while the main console is live
+
+        // Change check, then the broadcast if its slot is due
+        bool changed = runStatePipeline(pipeline, source.getFrame(), source.getFrameArrivalUs(),
+                                        broadcastRate.tracksTenths(), *this);
+
+        if (changed && debug) {
+            String info = sourceTag(source) + "Updated - Time: " + String(scoreData.timeFormatted) + 
+                        ", Home: " + String(scoreData.homeScore) + 
+                        ", Away: " + String(scoreData.awayScore) + 
+                        ", Type: " + String(scoreData.deviceType) + String(scoreData.deviceNumber);
+            debugWS(info);
+        }
+    }
+
+    // Only the time and running flag of a shot clock console are used
+    void mergeShotClock(UartSource& source) {
+        const ScoreFrame& frame = source.getFrame();
+        bool running = frame.deviceType == 'T';
+        if (shotClock.present && running == shotClock.running &&
+            strcmp(frame.timeFormatted, shotClock.time) == 0) {
+            return;
+        }
+
+        // Appearing, starting or stopping goes out right away, like the game clock
+        bool startStop = !shotClock.present || running != shotClock.running;
+        strcpy(shotClock.time, frame.timeFormatted);
+        shotClock.running = running;
+        shotClock.present = true;
+        shotArrivalUs = source.getFrameArrivalUs();
+        recordChange(broadcastRate.getPhase(), startStop, false, shotArrivalUs);
+        updateBroadcast();
+
+        if (debug) {
+            debugWS(sourceTag(source) + "Shot clock: " + String(shotClock.time) +
+                    (running ? " running" : " stopped"));
+        }
     }
 
-    void processMessage() {
+    void processMessage(UartSource& source) {
         // Use format-based parsing method
-        parseMessageFormat();
-        
-        // Only send WebSocket update if data has changed AND is valid
-        if (hasDataChanged()) {
-            // Validate data before sending
-            if (isDataValid()) {
-                sendWebSocketUpdate();
-                updatePreviousState();
-                lastValidDataTime = millis(); // Update this timestamp when valid data is processed
-                
-                if (debug) {
-                    String info = "Updated - Time: " + String(scoreData.timeFormatted) + 
-                                ", Home: " + String(scoreData.homeScore) + 
-                                ", Away: " + String(scoreData.awayScore) + 
-                                ", Type: " + String(deviceType) + String(deviceNumber);
-                    debugWS(info);
-                }
-            } else if (debug) {
-                debugWS("Invalid data detected - update skipped");
-            }
+        ScoreFrame frame = source.getFrame();
+        if (!parseMessageFormat(source, frame)) {
+            source.rejectFrame();
+            return;
+        }
+        source.acceptFrame(frame);
+        stateRestore.noteBaud(&source == &mainSource ? 0 : 1, source.getGoodBaudIndex());
+
+        if (source.getRole() == SOURCE_SHOT_CLOCK) {
+            mergeShotClock(source);
+        } else {
+            mergeGameClock(source);
         }
     }
 
 public:
-    SerialHandler() {
-        clearBuffer();
+    SerialHandler() {}
+
+    // The last state from before a restart, shown and served until the console sends again.
+    // Call before begin() so the inputs start at the baud rates that worked. Returns false if there was none.
+    bool restoreState() {
+        RestoredState restored;
+        if (!stateRestore.restore(restored)) return false;
+        scoreData = restored.frame;
+        scoreData.deviceType = 'D'; // Not known to be running until the console says so
+        pipeline.previous = scoreData;
+        stateSequence = restored.sequence; // Clients that resume see the numbering carry on
+        for (uint8_t i = 0; i < SOURCE_COUNT; i++) sources[i]->setGoodBaudIndex(restored.baudIndex[i]);
+        sendPipelineState(pipeline, *this, true); // /api/state serves it before the first frame
+        return true;
     }
 
+    // Starts every enabled console input. Also used to restart them as a failsafe.
     bool begin() {
-        Serial1.end();
-        delay(100);
-        Serial1.begin(9600, SERIAL_8N1, 19, 20);
-        Serial1.setTimeout(50); 
-        
-        unsigned long startTime = millis();
-        while (!Serial1 && (millis() - startTime < 1000)) {
-            delay(10);
+        bool ok = true;
+        for (UartSource* source : sources) {
+            if (!source->begin()) ok = false;
         }
+        return ok;
+    }
 
-        // Flush any leftover data
-        while (Serial1.available()) {
-            Serial1.read();
+    // Restarts inputs that have had no valid frame for timeout ms
+    void resetStaleSources(unsigned long timeout) {
+        for (UartSource* source : sources) {
+            if (!source->isStarted() || source->hasReceivedValidData(timeout)) continue;
+            if (debug) {
+                debugWS(sourceTag(*source) + "No valid data for extended period - resetting serial");
+            }
+            source->begin();
+        }
+    }
+
+    // Console inputs for the stall monitor
+    uint8_t getSourceCount() const { return SOURCE_COUNT; }
+    UartSource& getSource(uint8_t index) { return *sources[index]; }
+
+    // Role of the second console input, applied straight away
+    void setSecondSourceRole(SourceRole role) {
+        if (role > SOURCE_BACKUP) role = SOURCE_DISABLED;
+        if (role == SOURCE_MAIN) role = SOURCE_BACKUP; // There is only one main console
+        secondSource.setRole(role);
+        if (role != SOURCE_SHOT_CLOCK && shotClock.present) {
+            shotClock.present = false;
+            recordChange(broadcastRate.getPhase(), true, false, micros());
         }
+        selectClockSource();
+    }
+
+    SourceRole getSecondSourceRole() const {
+        return secondSource.getRole();
+    }
 
-        return Serial1;
+    // Light sleep can only wake on UART1, so a second input keeps the chip awake
+    bool canLightSleep() const {
+        return !secondSource.isStarted();
+    }
+
+    // Health of every console input for the /sources route
+    String getSourcesJson() {
+        DynamicJsonDocument doc(1024);
+        JsonArray list = doc.createNestedArray("sources");
+        unsigned long now = millis();
+        for (UartSource* source : sources) {
+            JsonObject entry = list.createNestedObject();
+            entry["name"] = source->getName();
+            entry["role"] = SOURCE_ROLE_NAMES[source->getRole()];
+            entry["health"] = SOURCE_HEALTH_NAMES[source->getHealth()];
+            entry["rxPin"] = source->getRxPin();
+            entry["txPin"] = source->getTxPin();
+            if (!source->isStarted()) continue;
+            entry["baud"] = source->getBaudRate();
+            entry["bytes"] = source->getBytesReceived();
+            entry["frames"] = source->getFramesDecoded();
+            entry["rejected"] = source->getFramesRejected();
+            entry["short"] = source->getShortMessages();
+            entry["lastByteAgeMs"] = source->getBytesReceived() ? now - source->getLastByteTime() : 0;
+            entry["lastFrameAgeMs"] = source->getFramesDecoded() ? now - source->getLastValidDataTime() : 0;
+            entry["feedsClock"] = source == clockSource;
+        }
+        String json;
+        serializeJson(doc, json);
+        return json;
     }
 
     void debugWS(const String& message) {
@@ -298,47 +433,14 @@ public:
     }
 
     void detectBaudRate() {
-        static int baudIndex = 0;
-        static unsigned long lastChange = 0;
-        static int baudRates[] = {9600, 19200, 38400, 57600, 115200};
-        static int failedAttempts = 0;
-        
-        // If we've received valid data recently (within 60 seconds), don't change baud rate
-        if (millis() - lastValidDataTime < 60000) {
-            failedAttempts = 0; // Reset failure counter when we're getting valid data
-            return;
-        }
-        
-        // Only try changing baud rate every 15 seconds
-        if (millis() - lastChange < 15000) {
-            return;
-        }
-        
-        // Check if we need to try another baud rate
-        if (Serial1.available() == 0) {
-            // If we've cycled through all baud rates multiple times with no success
-            // and haven't received valid data in 2 minutes, go back to default
-            if (failedAttempts > 10 && millis() - lastValidDataTime > 120000) {
-                baudIndex = 0; // Reset to 9600 (default rate)
-                failedAttempts = 0;
-                if (debug) {
-                    debugWS("Too many failures - resetting to default baud rate: 9600");
-                }
-            } else {
-                baudIndex = (baudIndex + 1) % 5;
-                failedAttempts++;
-            }
-            
-            Serial1.end();
-            delay(100);
-            Serial1.begin(baudRates[baudIndex], SERIAL_8N1, 19, 20);
-            
-            if (debug) {
-                debugWS("Trying baud rate: " + String(baudRates[baudIndex]));
+        for (UartSource* source : sources) {
+            long baud = source->detectBaudRate();
+            if (!debug) continue;
+            if (baud != 0) {
+                debugWS(sourceTag(*source) + "Trying baud rate: " + String(baud));
+            } else if (source->isStarted() && !source->hasReceivedValidData(60000) && source->available() > 0) {
+                debugWS(sourceTag(*source) + "Data detected at current baud rate");
             }
-            lastChange = millis();
-        } else if (debug) {
-            debugWS("Data detected at current baud rate");
         }
     }
 
@@ -348,57 +450,24 @@ public:
         static unsigned long lastCheckTime = 0;
         if (currentTime - lastCheckTime > 5000) { // Every 5 seconds
             if (debug) {
-                String status = "Serial status - Available: " + String(Serial1.available()) + " bytes";
-                debugWS(status);
+                for (UartSource* source : sources) {
+                    if (!source->isStarted()) continue;
+                    String status = sourceTag(*source) + "Serial status - Available: " +
+                                    String(source->available()) + " bytes";
+                    debugWS(status);
+                }
             }
             lastCheckTime = currentTime;
         }
 
-        // Process data in chunks if enough is available
-        if (Serial1.available() >= 13) { // We need at least a complete message
-            clearBuffer();
-            unsigned long readStart = millis();
-            
-            // Read up to a complete message
-            while (Serial1.available() > 0 && message_pos < MAX_MESSAGE_LENGTH - 1 && 
-                   (millis() - readStart < 50)) { // 50ms max reading time
-                message[message_pos] = Serial1.read();
-                message_pos++;
-            }
-            
-            message[message_pos] = '\0';
-            
-            // Process this chunk immediately
-            if (message_pos >= 13) {
-                if (debug) debugWS("Processing complete message chunk");
-                processMessage();
-                clearBuffer();
+        // Every complete message from every input, as soon as it is there
+        for (UartSource* source : sources) {
+            while (source->poll(currentTime)) {
+                if (debug) debugWS(sourceTag(*source) + "Processing message");
+                processMessage(*source);
+                source->consumeMessage();
             }
         }
-        
-        // Check for timeout on any remaining partial data
-        if (message_pos > 0 && (currentTime - lastByteTime > BYTE_TIMEOUT)) {
-            message[message_pos] = '\0';
-            
-            // Only process complete messages
-            if (message_pos >= 13) {
-                if (debug) debugWS("Processing message after timeout");
-                processMessage();
-            } else if (debug) {
-                debugWS("Message too short after timeout: " + String(message_pos) + " bytes");
-            }
-            
-            clearBuffer();
-        }
-        
-        // Read any additional bytes (if not enough for a chunk)
-        while (Serial1.available() > 0 && message_pos < MAX_MESSAGE_LENGTH - 1) {
-            char inByte = Serial1.read();
-            lastByteTime = currentTime;
-            
-            message[message_pos] = inByte;
-            message_pos++;
-        }
     }
 
     void sendTestData() {
@@ -406,19 +475,21 @@ public:
         strcpy(scoreData.timeFormatted, "12:34");
         strcpy(scoreData.homeScore, "05");
         strcpy(scoreData.awayScore, "03");
+        strcpy(scoreData.subSecond, "00");
         scoreData.channel = 1;
-        deviceType = 'T';
-        deviceNumber = '2';
+        scoreData.deviceType = 'T';
+        scoreData.deviceNumber = '2';
         
         // Send to WebSocket
         if (ws.count() > 0) {
-            StaticJsonDocument<200> doc;
+            StaticJsonDocument<256> doc;
             doc["time"] = scoreData.timeFormatted;
             doc["home"] = scoreData.homeScore;
             doc["away"] = scoreData.awayScore;
-            doc["deviceType"] = String(deviceType) + String(deviceNumber);
+            doc["deviceType"] = String(scoreData.deviceType) + String(scoreData.deviceNumber);
             doc["channel"] = scoreData.channel;
             doc["isRunning"] = true;
+            doc["tenths"] = String(scoreData.subSecond[0]);
             doc["source"] = "test"; // Identify as test data
             
             String jsonString;
@@ -439,41 +510,95 @@ public:
     }
 
     bool hasReceivedValidData(unsigned long timeout) {
-        return (millis() - lastValidDataTime < timeout);
+        for (UartSource* source : sources) {
+            if (source->hasReceivedValidData(timeout)) return true;
+        }
+        return false;
     }
 
     bool getDebug() const {
         return debug;
     }
 
+    // async_tcp task: a page asked for the state. The loop sends it on its next pass.
     void sendCurrentState() {
-        if (isDataValid()) {
-            sendWebSocketUpdate();
-            if (debug) {
-                debugWS("Current state sent to client");
-            }
+        currentStateRequested = true;
+        wakeLoop();
+    }
+
+    // Call every loop pass: sends pending changes at the rate of the current game phase,
+    // and the slow heartbeat when nothing changes
+    void updateBroadcast() {
+        broadcastState(pipeline, *this);
+    }
+
+    uint32_t getStateSequence() const { return stateSequence; }
+    unsigned long getStateChanges() const { return stateChanges; }
+    // Latest byte from any input
+    unsigned long getLastByteTime() const {
+        unsigned long latest = mainSource.getLastByteTime();
+        unsigned long now = millis();
+        if (secondSource.isStarted() && now - secondSource.getLastByteTime() < now - latest) {
+            latest = secondSource.getLastByteTime();
         }
+        return latest;
+    }
+
+    // True while a partial frame or a rate-limited update is waiting on a timer
+    bool isBusy() const {
+        return mainSource.hasPartialMessage() || secondSource.hasPartialMessage() || broadcastRate.isPending();
     }
 
-    char getDeviceType() const { return deviceType; }
-    bool isTimeRunning() const { return deviceType == 'T'; }
+    // Called when the network link goes down or comes back
+    void setNetworkOnline(bool online) {
+        if (online == networkOnline) return;
+        networkOnline = online;
+
+        if (!online) {
+            outageStart = millis();
+            outageChanges = 0;
+            outageScoreChanges = 0;
+            return;
+        }
+
+        // One coalesced catch-up with the latest state as soon as clients can hear it
+        broadcastRate.forceNext();
+        updateBroadcast();
+        if (debug && outageStart != 0) {
+            debugWS("Link restored after " + String((millis() - outageStart) / 1000) + "s - " +
+                    String(outageChanges) + " state changes, " + String(outageScoreChanges) +
+                    " score changes caught up");
+        }
+    }
+
+    bool isNetworkOnline() const { return networkOnline; }
+
+    GamePhase getGamePhase() const { return broadcastRate.getPhase(); }
+
+    char getDeviceType() const { return scoreData.deviceType; }
+    bool isTimeRunning() const { return scoreData.deviceType == 'T'; }
     
-    String getTimeFormatted() const { 
-        return String(scoreData.timeFormatted); 
+    // Views of the current state, valid until the next frame is merged
+    const char* getTimeFormatted() const { 
+        return scoreData.timeFormatted; 
     }
     
-    String getHomeScore() const { 
-        return String(scoreData.homeScore); 
+    const char* getHomeScore() const { 
+        return scoreData.homeScore; 
     }
     
-    String getAwayScore() const { 
-        return String(scoreData.awayScore); 
+    const char* getAwayScore() const { 
+        return scoreData.awayScore; 
     }
     
     int getChannel() const {
         return scoreData.channel;
     }
 
+    bool hasShotClock() const { return shotClock.present; }
+    const char* getShotClock() const { return shotClock.time; }
+    bool isShotClockRunning() const { return shotClock.running; }
+
     void setDebug(bool enabled) {
         debug = enabled;
     }
@@ -482,4 +607,9 @@ public:
 
 extern SerialHandler serialHandler;
 
+// Used by the /sources route in WebRoutes.h
+String getSourcesReport() {
+    return serialHandler.getSourcesJson();
+}
+
 #endif
\ No newline at end of file
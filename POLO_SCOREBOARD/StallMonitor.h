@@ -0,0 +1,492 @@
+#ifndef STALL_MONITOR_H
+#define STALL_MONITOR_H
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include <AsyncWebSocket.h>
+#include <Preferences.h>
+#include <esp_idf_version.h>
+#include <esp_system.h>
+#include <esp_task_wdt.h>
+#include "LatencyTracker.h"
+#include "SerialHandler.h"
+
+extern AsyncWebSocket ws;
+extern Preferences preferences;
+
+// Watches the loop, the console inputs and the WebSocket clients for stalls and recovers
+// one step at a time instead of restarting straight away:
+//   flush the decoder -> reset the UART -> evict clients -> restart
+// Each step gets STEP_INTERVAL to clear the stall before the next one. The task watchdog
+// covers the loop task (AsyncTCP subscribes its own task when built with CONFIG_ASYNC_TCP_USE_WDT),
+// so a loop that stops running still ends in a restart. /health shows what happened.
+
+enum StallKind {
+    STALL_NONE,
+    STALL_LOOP,     // One loop iteration took too long (recorded, the watchdog handles real hangs)
+    STALL_INGEST,   // A console that was decoding fine now only sends garbage, or the driver is stuck
+    STALL_NETWORK   // A client stopped answering pings or its send queue stays full
+};
+
+enum RecoveryStep {
+    RECOVERY_NONE,
+    RECOVERY_FLUSH_DECODER,
+    RECOVERY_RESET_UART,
+    RECOVERY_EVICT_CLIENTS,
+    RECOVERY_RESTART,
+    RECOVERY_STEP_COUNT
+};
+
+static const char* const STALL_NAMES[] = {"none", "loop", "ingest", "network"};
+static const char* const RECOVERY_STEP_NAMES[] = {"none", "flushDecoder", "resetUart", "evictClients", "restart"};
+static const char* const RESET_REASON_NAMES[] = {
+    "unknown", "powerOn", "external", "software", "panic", "interruptWatchdog",
+    "taskWatchdog", "watchdog", "deepSleep", "brownout", "sdio"
+};
+
+// Survives a software or watchdog restart, not a power cycle
+struct StallRestartRecord {
+    uint32_t magic;
+    uint8_t stall;
+    uint8_t chain;        // Stall restarts in a row
+    uint32_t uptimeMs;
+};
+RTC_NOINIT_ATTR StallRestartRecord stallRestartRecord;
+
+class StallMonitor {
+private:
+    // Configuration
+    static const uint32_t WATCHDOG_TIMEOUT_S = 8;           // Longest legitimate block is the 5 s Wi-Fi reset message
+    static const unsigned long CHECK_INTERVAL = 1000;
+    static const unsigned long PING_INTERVAL = 5000;        // WebSocket ping to every client
+    static const unsigned long INGEST_STALL_TIME = 10000;   // Garbage with no valid frame for this long
+    static const unsigned long NETWORK_STALL_TIME = 15000;  // No pong, or a full send queue, for this long
+    static const unsigned long STEP_INTERVAL = 10000;       // Time a step gets before the next one
+    static const unsigned long CLEAR_TIME = 60000;          // Stall gone this long: back to the first step
+    static const uint32_t LOOP_STALL_US = 500000;           // Iterations over this are recorded
+    static const uint8_t MAX_RESTART_CHAIN = 3;             // Stall restarts in a row before holding off
+    static const unsigned long RESTART_CHAIN_WINDOW = 600000; // A stall this soon after a stall restart continues the chain
+    static const uint32_t RECORD_MAGIC = 0x5354414C;        // "STAL"
+    static const uint8_t MAX_CLIENTS = 16;
+    static const uint8_t EVENT_COUNT = 16;
+
+    struct ClientHealth {
+        bool used;
+        uint32_t clientId;
+        unsigned long connectedMs;
+        unsigned long lastPongMs;
+        unsigned long queueFullSinceMs;  // 0 while the queue has room
+    };
+
+    struct RecoveryEvent {
+        uint32_t atMs;
+        uint8_t stall;
+        uint8_t step;
+        char detail[24];
+    };
+
+    // Loop task measurements
+    LatencyHistogram loopIterations;
+    uint32_t iterationStartUs = 0;
+    LatencyHistogram pongs;          // Ping to pong, through the network and the async_tcp task
+    unsigned long lastPingMs = 0;
+    uint32_t pingSentUs = 0;
+    unsigned long lastCheckMs = 0;
+
+    // Console inputs: when each started looking stalled, 0 if it doesn't
+    unsigned long ingestSuspectSince[4] = {0, 0, 0, 0};
+
+    // Clients are added and pong on the async_tcp task, checked on the loop task
+    ClientHealth clients[MAX_CLIENTS];
+    portMUX_TYPE lock = portMUX_INITIALIZER_UNLOCKED;
+
+    // Escalation
+    StallKind activeStall = STALL_NONE;
+    RecoveryStep step = RECOVERY_NONE;
+    unsigned long lastActionMs = 0;
+    unsigned long lastStallSeenMs = 0;
+    bool restartHeld = false;
+
+    // What happened, for /health. Totals are kept in Preferences across restarts.
+    RecoveryEvent events[EVENT_COUNT];
+    uint8_t eventNext = 0;
+    uint8_t eventTotal = 0;
+    uint32_t totals[RECOVERY_STEP_COUNT];
+    uint32_t resolvedBy[RECOVERY_STEP_COUNT];   // Last step taken before a stall cleared
+    uint32_t loopStalls = 0;
+    esp_reset_reason_t resetReason = ESP_RST_UNKNOWN;
+    uint8_t previousStall = STALL_NONE;          // Stall behind the last restart, if it was ours
+    uint8_t restartChain = 0;
+
+    void recordEvent(StallKind stall, RecoveryStep recoveryStep, const char* detail) {
+        portENTER_CRITICAL(&lock);
+        RecoveryEvent& event = events[eventNext];
+        event.atMs = millis();
+        event.stall = stall;
+        event.step = recoveryStep;
+        strncpy(event.detail, detail, sizeof(event.detail) - 1);
+        event.detail[sizeof(event.detail) - 1] = '\0';
+        eventNext = (eventNext + 1) % EVENT_COUNT;
+        if (eventTotal < EVENT_COUNT) eventTotal++;
+        if (recoveryStep != RECOVERY_NONE) totals[recoveryStep]++;
+        portEXIT_CRITICAL(&lock);
+
+        if (recoveryStep != RECOVERY_NONE) preferences.putBytes("recoveries", totals, sizeof(totals));
+        Serial.printf("Stall (%s): %s %s\n", STALL_NAMES[stall], RECOVERY_STEP_NAMES[recoveryStep], detail);
+        serialHandler.debugWS(String("Stall (") + STALL_NAMES[stall] + "): " + RECOVERY_STEP_NAMES[recoveryStep] + " " + detail);
+    }
+
+    ClientHealth* findClient(uint32_t clientId) {
+        for (uint8_t i = 0; i < MAX_CLIENTS; i++) {
+            if (clients[i].used && clients[i].clientId == clientId) return &clients[i];
+        }
+        return nullptr;
+    }
+
+    bool isClientWedged(const ClientHealth& client, unsigned long now) const {
+        if (client.queueFullSinceMs != 0 && now - client.queueFullSinceMs >= NETWORK_STALL_TIME) return true;
+        unsigned long heardFrom = client.lastPongMs != 0 ? client.lastPongMs : client.connectedMs;
+        return now - heardFrom >= NETWORK_STALL_TIME;
+    }
+
+    // The UART driver has seen bytes in the last second
+    bool isReceiving(UartSource& source) const {
+        uint32_t rxEventUs = source.getRxEventUs();
+        return rxEventUs != 0 && micros() - rxEventUs < 1000000UL;
+    }
+
+    // Console that was decoding and now only sends garbage, or whose driver reports bytes nobody can read
+    int findStalledSource(unsigned long now) {
+        int stalled = -1;
+        for (uint8_t i = 0; i < serialHandler.getSourceCount() && i < 4; i++) {
+            UartSource& source = serialHandler.getSource(i);
+            bool suspect = false;
+            if (source.isStarted() && source.getRole() != SOURCE_DISABLED) {
+                bool driverStuck = isReceiving(source) && now - source.getLastByteTime() >= INGEST_STALL_TIME;
+                suspect = source.getHealth() == SOURCE_HEALTH_GARBLED || driverStuck;
+            }
+            if (!suspect) {
+                ingestSuspectSince[i] = 0;
+                continue;
+            }
+            if (ingestSuspectSince[i] == 0) ingestSuspectSince[i] = now;
+            // Never decoded anything: baud detection's job, not a stall
+            if (source.getFramesDecoded() > 0 && now - ingestSuspectSince[i] >= INGEST_STALL_TIME && stalled < 0) {
+                stalled = i;
+            }
+        }
+        return stalled;
+    }
+
+    uint8_t countWedgedClients(unsigned long now) {
+        uint8_t wedged = 0;
+        for (uint8_t i = 0; i < MAX_CLIENTS; i++) {
+            portENTER_CRITICAL(&lock);
+            bool used = clients[i].used;
+            uint32_t clientId = clients[i].clientId;
+            portEXIT_CRITICAL(&lock);
+            if (!used) continue;
+
+            AsyncWebSocketClient* client = ws.client(clientId);
+            bool full = client != nullptr && client->queueIsFull();
+            portENTER_CRITICAL(&lock);
+            if (!full) {
+                clients[i].queueFullSinceMs = 0;
+            } else if (clients[i].queueFullSinceMs == 0) {
+                clients[i].queueFullSinceMs = now;
+            }
+            if (isClientWedged(clients[i], now)) wedged++;
+            portEXIT_CRITICAL(&lock);
+        }
+        return wedged;
+    }
+
+    // Only clients that have stopped answering, whatever the stall: the rest are fine where they are
+    void evictWedgedClients(StallKind stall, unsigned long now) {
+        uint8_t evicted = 0;
+        for (uint8_t i = 0; i < MAX_CLIENTS; i++) {
+            portENTER_CRITICAL(&lock);
+            bool wedged = clients[i].used && isClientWedged(clients[i], now);
+            uint32_t clientId = clients[i].clientId;
+            if (wedged) clients[i].used = false;
+            portEXIT_CRITICAL(&lock);
+            if (!wedged) continue;
+            ws.close(clientId);
+            evicted++;
+        }
+        char detail[24];
+        snprintf(detail, sizeof(detail), "%u client(s)", evicted);
+        recordEvent(stall, RECOVERY_EVICT_CLIENTS, detail);
+    }
+
+    bool restartAllowed() const {
+        return restartChain < MAX_RESTART_CHAIN;
+    }
+
+    void recover(StallKind stall, int sourceIndex, unsigned long now) {
+        lastActionMs = now;
+        UartSource* source = sourceIndex >= 0 ? &serialHandler.getSource(sourceIndex) : nullptr;
+        char detail[24];
+
+        switch (step) {
+            case RECOVERY_FLUSH_DECODER:
+                if (source == nullptr) break;
+                snprintf(detail, sizeof(detail), "%s, %u bytes", source->getName(), (unsigned)source->flush());
+                recordEvent(stall, step, detail);
+                break;
+            case RECOVERY_RESET_UART:
+                if (source == nullptr) break;
+                source->begin();
+                recordEvent(stall, step, source->getName());
+                break;
+            case RECOVERY_EVICT_CLIENTS:
+                evictWedgedClients(stall, now);
+                break;
+            case RECOVERY_RESTART:
+                // A console that is still sending needs its line sorted out, a restart wouldn't change
+                // what arrives. Keep resetting its UART instead.
+                if (stall == STALL_INGEST && source != nullptr && isReceiving(*source)) {
+                    if (!restartHeld) recordEvent(stall, step, "held, console still sending");
+                    restartHeld = true;
+                    source->begin();
+                    break;
+                }
+                if (!restartAllowed()) {
+                    if (!restartHeld) recordEvent(stall, step, "held, too many in a row");
+                    restartHeld = true;
+                    break;
+                }
+                recordEvent(stall, step, "");
+                stallRestartRecord.magic = RECORD_MAGIC;
+                stallRestartRecord.stall = stall;
+                stallRestartRecord.chain = restartChain + 1;
+                stallRestartRecord.uptimeMs = now;
+                delay(100); // Let the log and debug message out
+                ESP.restart();
+                break;
+            default:
+                break;
+        }
+    }
+
+    void check(unsigned long now) {
+        int sourceIndex = findStalledSource(now);
+        StallKind stall = STALL_NONE;
+        if (sourceIndex >= 0) {
+            stall = STALL_INGEST;
+        } else if (countWedgedClients(now) > 0) {
+            stall = STALL_NETWORK;
+        }
+
+        if (stall == STALL_NONE) {
+            if (activeStall != STALL_NONE && now - lastStallSeenMs >= CLEAR_TIME) {
+                char detail[24];
+                snprintf(detail, sizeof(detail), "cleared by %s", RECOVERY_STEP_NAMES[step]);
+                portENTER_CRITICAL(&lock);
+                resolvedBy[step]++;
+                portEXIT_CRITICAL(&lock);
+                recordEvent(activeStall, RECOVERY_NONE, detail);
+                activeStall = STALL_NONE;
+                step = RECOVERY_NONE;
+                restartHeld = false;
+            }
+            return;
+        }
+        lastStallSeenMs = now;
+
+        // Ingest stalls start at the decoder, network stalls can only be helped from eviction on
+        RecoveryStep first = stall == STALL_INGEST ? RECOVERY_FLUSH_DECODER : RECOVERY_EVICT_CLIENTS;
+        if (activeStall == STALL_NONE) {
+            step = first;
+        } else if (now - lastActionMs < STEP_INTERVAL) {
+            return; // Give the last step time to work
+        } else if (step < RECOVERY_RESTART) {
+            step = (RecoveryStep)(step + 1);
+        }
+        if (step < first) step = first;
+        activeStall = stall;
+        recover(stall, sourceIndex, now);
+    }
+
+public:
+    StallMonitor() {
+        for (uint8_t i = 0; i < MAX_CLIENTS; i++) clients[i].used = false;
+        memset(totals, 0, sizeof(totals));
+        memset(resolvedBy, 0, sizeof(resolvedBy));
+    }
+
+    // Call at the end of setup(), after preferences.begin()
+    void begin() {
+        resetReason = esp_reset_reason();
+        if (stallRestartRecord.magic == RECORD_MAGIC && resetReason == ESP_RST_SW) {
+            previousStall = stallRestartRecord.stall;
+            // A restart soon after the last one continues the chain, a long healthy run ends it
+            restartChain = stallRestartRecord.uptimeMs < RESTART_CHAIN_WINDOW ? stallRestartRecord.chain : 0;
+        }
+        stallRestartRecord.magic = 0;
+        if (preferences.getBytesLength("recoveries") == sizeof(totals)) {
+            preferences.getBytes("recoveries", totals, sizeof(totals));
+        }
+
+        // Panic on a missed feed so a hung loop restarts instead of sitting there
+#if ESP_IDF_VERSION_MAJOR >= 5
+        esp_task_wdt_config_t config;
+        config.timeout_ms = WATCHDOG_TIMEOUT_S * 1000;
+        config.idle_core_mask = 0;
+        config.trigger_panic = true;
+        esp_task_wdt_reconfigure(&config);
+#else
+        esp_task_wdt_init(WATCHDOG_TIMEOUT_S, true);
+#endif
+        esp_task_wdt_add(nullptr); // The loop task, setup() runs on it
+        lastCheckMs = millis();
+    }
+
+    // Top of loop()
+    void beginIteration() {
+        esp_task_wdt_reset();
+        iterationStartUs = micros();
+    }
+
+    // Before the loop's idle wait, so only work is measured
+    void endIteration() {
+        uint32_t workUs = micros() - iterationStartUs;
+        portENTER_CRITICAL(&lock);
+        loopIterations.record(workUs);
+        portEXIT_CRITICAL(&lock);
+        if (workUs >= LOOP_STALL_US) {
+            loopStalls++;
+            char detail[24];
+            snprintf(detail, sizeof(detail), "%u ms iteration", (unsigned)(workUs / 1000));
+            recordEvent(STALL_LOOP, RECOVERY_NONE, detail);
+        }
+
+        unsigned long now = millis();
+        if (ws.count() > 0 && now - lastPingMs >= PING_INTERVAL) {
+            lastPingMs = now;
+            pingSentUs = micros();
+            ws.pingAll();
+        }
+        if (now - lastCheckMs >= CHECK_INTERVAL) {
+            lastCheckMs = now;
+            check(now);
+        }
+    }
+
+    // WebSocket events, on the async_tcp task
+    void clientConnected(uint32_t clientId) {
+        portENTER_CRITICAL(&lock);
+        ClientHealth* slot = findClient(clientId);
+        for (uint8_t i = 0; i < MAX_CLIENTS && slot == nullptr; i++) {
+            if (!clients[i].used) slot = &clients[i];
+        }
+        if (slot != nullptr) {
+            slot->used = true;
+            slot->clientId = clientId;
+            slot->connectedMs = millis();
+            slot->lastPongMs = 0;
+            slot->queueFullSinceMs = 0;
+        }
+        portEXIT_CRITICAL(&lock);
+    }
+
+    void clientDisconnected(uint32_t clientId) {
+        portENTER_CRITICAL(&lock);
+        ClientHealth* slot = findClient(clientId);
+        if (slot != nullptr) slot->used = false;
+        portEXIT_CRITICAL(&lock);
+    }
+
+    void clientPong(uint32_t clientId) {
+        uint32_t pongUs = micros() - pingSentUs;
+        portENTER_CRITICAL(&lock);
+        ClientHealth* slot = findClient(clientId);
+        if (slot != nullptr) slot->lastPongMs = millis();
+        pongs.record(pongUs);
+        portEXIT_CRITICAL(&lock);
+    }
+
+    String toJson() {
+        DynamicJsonDocument doc(4096);
+        unsigned long now = millis();
+        doc["uptimeMs"] = now;
+        doc["resetReason"] = resetReason <= ESP_RST_SDIO ? RESET_REASON_NAMES[resetReason] : "unknown";
+        if (previousStall != STALL_NONE) doc["restartedFor"] = STALL_NAMES[previousStall];
+        doc["restartChain"] = restartChain;
+        doc["watchdogS"] = WATCHDOG_TIMEOUT_S;
+        doc["freeHeap"] = ESP.getFreeHeap();
+        doc["minFreeHeap"] = ESP.getMinFreeHeap();
+
+        LatencyHistogram copy;
+        portENTER_CRITICAL(&lock);
+        copy = loopIterations;
+        portEXIT_CRITICAL(&lock);
+        copy.toJson(doc.createNestedObject("loop"), false);
+        doc["loopStalls"] = loopStalls;
+        portENTER_CRITICAL(&lock);
+        copy = pongs;
+        portEXIT_CRITICAL(&lock);
+        copy.toJson(doc.createNestedObject("ping"), false);
+
+        JsonArray clientArr = doc.createNestedArray("clients");
+        for (uint8_t i = 0; i < MAX_CLIENTS; i++) {
+            portENTER_CRITICAL(&lock);
+            ClientHealth client = clients[i];
+            portEXIT_CRITICAL(&lock);
+            if (!client.used) continue;
+            JsonObject entry = clientArr.createNestedObject();
+            entry["id"] = client.clientId;
+            entry["connectedMs"] = now - client.connectedMs;
+            if (client.lastPongMs != 0) entry["pongAgeMs"] = now - client.lastPongMs;
+            entry["queueFullMs"] = client.queueFullSinceMs != 0 ? now - client.queueFullSinceMs : 0;
+        }
+
+        JsonObject stallObj = doc.createNestedObject("stall");
+        stallObj["active"] = STALL_NAMES[activeStall];
+        stallObj["step"] = RECOVERY_STEP_NAMES[step];
+
+        JsonObject totalObj = doc.createNestedObject("recoveries");
+        JsonObject resolvedObj = doc.createNestedObject("resolvedBy");
+        for (uint8_t i = RECOVERY_FLUSH_DECODER; i < RECOVERY_STEP_COUNT; i++) {
+            portENTER_CRITICAL(&lock);
+            uint32_t total = totals[i];
+            uint32_t resolved = resolvedBy[i];
+            portEXIT_CRITICAL(&lock);
+            totalObj[RECOVERY_STEP_NAMES[i]] = total;
+            resolvedObj[RECOVERY_STEP_NAMES[i]] = resolved;
+        }
+
+        // Newest first
+        JsonArray eventArr = doc.createNestedArray("events");
+        for (uint8_t n = 0; n < eventTotal; n++) {
+            portENTER_CRITICAL(&lock);
+            RecoveryEvent event = events[(eventNext + EVENT_COUNT - 1 - n) % EVENT_COUNT];
+            portEXIT_CRITICAL(&lock);
+            JsonObject entry = eventArr.createNestedObject();
+            entry["ageMs"] = now - event.atMs;
+            entry["stall"] = STALL_NAMES[event.stall];
+            entry["step"] = RECOVERY_STEP_NAMES[event.step];
+            entry["detail"] = (const char*)event.detail;
+        }
+
+        String json;
+        serializeJson(doc, json);
+        return json;
+    }
+};
+
+extern StallMonitor stallMonitor;
+
+// Used by onEvent in WebSocketSetup.h
+void noteClientEvent(uint32_t clientId, AwsEventType type) {
+    if (type == WS_EVT_CONNECT) stallMonitor.clientConnected(clientId);
+    if (type == WS_EVT_DISCONNECT) stallMonitor.clientDisconnected(clientId);
+    if (type == WS_EVT_PONG) stallMonitor.clientPong(clientId);
+}
+
+// Used by the /health route in WebRoutes.h
+String getHealthReport() {
+    return stallMonitor.toJson();
+}
+
+#endif // STALL_MONITOR_H
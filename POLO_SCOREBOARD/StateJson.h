@@ -0,0 +1,109 @@
+// snprintf-based writer for the state message the bridge broadcasts (see StatePipeline.h).
+// The schema is declared once below and expands into a single snprintf per member list.
+// Writes into a caller's fixed buffer so the per-frame path never touches the heap, and
+// produces the same text serializeJson() gave for the ArduinoJson document it replaced.
+// Plain C++ so the Linux benchmarks and allocation check run it too.
+#ifndef STATE_JSON_H
+#define STATE_JSON_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include "FrameDecoder.h"
+
+// Same escapes as ArduinoJson 6, everything else is written as is
+inline size_t formatJsonChar(char c, char* out) {
+    char escaped = 0;
+    switch (c) {
+        case '"':  escaped = '"'; break;
+        case '\\': escaped = '\\'; break;
+        case '\b': escaped = 'b'; break;
+        case '\f': escaped = 'f'; break;
+        case '\n': escaped = 'n'; break;
+        case '\r': escaped = 'r'; break;
+        case '\t': escaped = 't'; break;
+    }
+    if (escaped) {
+        out[0] = '\\';
+        out[1] = escaped;
+        out[2] = '\0';
+        return 2;
+    }
+    out[0] = c;
+    out[1] = '\0';
+    return 1;
+}
+
+// Everything in a state message besides the frame itself
+struct StateJsonFields {
+    uint32_t sequence = 0;
+    uint32_t arrivalUs = 0;             // "ts": UART arrival of the change
+    uint32_t sentUs = 0;                // "bt": send time, clock-synced pages show the update from it
+    const char* clockSource = nullptr;  // Set with a second console: the input feeding the game clock
+    uint32_t clockUs = 0;
+    const char* shotClock = nullptr;    // Set with a shot clock console: its "mm:ss"
+    bool shotRunning = false;
+    uint32_t shotUs = 0;
+};
+
+// Room for the longest message, with every optional member
+static const size_t STATE_JSON_CAPACITY = 384;
+
+// The state message schema, declared once: X(key, printf format, arguments...).
+// formatStateJson() turns each list into one format string and one argument list at compile
+// time, so a member can't get out of step with its value. Members go out in this order.
+#define STATE_JSON_MEMBERS(X) \
+    X("time",        "\"%s\"",   frame.timeFormatted) \
+    X("home",        "\"%s\"",   frame.homeScore) \
+    X("away",        "\"%s\"",   frame.awayScore) \
+    X("deviceType",  "\"%s%s\"", type, number) \
+    X("channel",     "%d",       frame.channel) \
+    X("isRunning",   "%s",       frame.deviceType == 'T' ? "true" : "false") \
+    X("tenths",      "\"%s\"",   tenths) \
+    X("seq",         "%lu",      (unsigned long)fields.sequence) \
+    X("ts",          "%lu",      (unsigned long)fields.arrivalUs) \
+    X("bt",          "%lu",      (unsigned long)fields.sentUs) \
+    X("source",      "\"%s\"",   "scoreboard")
+
+// With a second console
+#define STATE_JSON_CLOCK_MEMBERS(X) \
+    X("clockSource", "\"%s\"",   fields.clockSource) \
+    X("clockTs",     "%lu",      (unsigned long)fields.clockUs)
+
+// With a shot clock console
+#define STATE_JSON_SHOT_MEMBERS(X) \
+    X("shotClock",   "\"%s\"",   fields.shotClock) \
+    X("shotRunning", "%s",       fields.shotRunning ? "true" : "false") \
+    X("shotTs",      "%lu",      (unsigned long)fields.shotUs)
+
+#define STATE_JSON_FORMAT(key, format, ...) ",\"" key "\":" format
+#define STATE_JSON_ARGUMENTS(key, format, ...) , __VA_ARGS__
+
+// Appends one member list at pos, formatStateJson() returns 0 if it doesn't fit
+#define STATE_JSON_APPEND(members) \
+    do { \
+        int len = snprintf(buf + pos, capacity - pos, members(STATE_JSON_FORMAT) members(STATE_JSON_ARGUMENTS)); \
+        if (len < 0 || (size_t)len >= capacity - pos) return 0; \
+        pos += (size_t)len; \
+    } while (0)
+
+// Returns the length written, or 0 if buf is too small. Never allocates.
+inline size_t formatStateJson(char* buf, size_t capacity, const ScoreFrame& frame, const StateJsonFields& fields) {
+    char type[3], number[3], tenths[3];
+    formatJsonChar(frame.deviceType, type);
+    formatJsonChar(frame.deviceNumber, number);
+    formatJsonChar(frame.subSecond[0], tenths);
+
+    // Every list starts with a comma, the first one's becomes the opening brace
+    size_t pos = 0;
+    STATE_JSON_APPEND(STATE_JSON_MEMBERS);
+    buf[0] = '{';
+    if (fields.clockSource != nullptr) STATE_JSON_APPEND(STATE_JSON_CLOCK_MEMBERS);
+    if (fields.shotClock != nullptr) STATE_JSON_APPEND(STATE_JSON_SHOT_MEMBERS);
+
+    if (pos + 2 > capacity) return 0;
+    buf[pos++] = '}';
+    buf[pos] = '\0';
+    return pos;
+}
+
+#endif // STATE_JSON_H
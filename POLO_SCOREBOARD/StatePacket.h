@@ -0,0 +1,133 @@
+// Compact binary state datagram published over UDP multicast.
+// Plain C++ with no Arduino dependencies so the Linux tools can include it too.
+//
+// Layout (version 2, 25 bytes, multi-byte fields big-endian):
+//   0-1  magic 'P' 'S'
+//   2    version
+//   3    flags (bit 0 clock running, bit 1 test data, bit 2 clock from the backup console)
+//   4-7  sequence number
+//   8    channel
+//   9    device type ('T' or 'D')
+//   10   device number (ASCII digit)
+//   11   minutes
+//   12   seconds
+//   13   tenths (0-9)
+//   14   home score
+//   15   away score
+//   16   game phase
+//   17   reserved
+//   18-21 boot id, random and non-zero, new on every bridge boot
+// Added in version 2:
+//   22   shot clock minutes
+//   23   shot clock seconds
+//   24   shot clock flags (bit 0 present, bit 1 running)
+// Newer versions only ever append fields, so a v1 reader accepts any longer packet.
+#ifndef STATE_PACKET_H
+#define STATE_PACKET_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define STATE_PACKET_MAGIC_0 'P'
+#define STATE_PACKET_MAGIC_1 'S'
+#define STATE_PACKET_VERSION 2
+#define STATE_PACKET_SIZE 25
+#define STATE_PACKET_V1_SIZE 22
+
+// Default multicast group and port
+#define STATE_MULTICAST_GROUP "239.255.42.42"
+#define STATE_MULTICAST_PORT 4242
+
+#define STATE_FLAG_RUNNING 0x01
+#define STATE_FLAG_TEST    0x02
+#define STATE_FLAG_BACKUP  0x04
+
+#define SHOT_FLAG_PRESENT  0x01
+#define SHOT_FLAG_RUNNING  0x02
+
+struct StatePacket {
+    uint8_t version = STATE_PACKET_VERSION;
+    uint8_t flags = 0;
+    uint32_t sequence = 0;
+    uint8_t channel = 0;
+    char deviceType = 'D';
+    char deviceNumber = '0';
+    uint8_t minutes = 0;
+    uint8_t seconds = 0;
+    uint8_t tenths = 0;
+    uint8_t homeScore = 0;
+    uint8_t awayScore = 0;
+    uint8_t phase = 0;
+    uint32_t bootId = 0;
+    uint8_t shotMinutes = 0;
+    uint8_t shotSeconds = 0;
+    uint8_t shotFlags = 0;
+};
+
+// Writes the packet into buf, returns the number of bytes written or 0 if buf is too small
+inline size_t encodeStatePacket(const StatePacket& packet, uint8_t* buf, size_t capacity) {
+    if (capacity < STATE_PACKET_SIZE) return 0;
+
+    buf[0] = STATE_PACKET_MAGIC_0;
+    buf[1] = STATE_PACKET_MAGIC_1;
+    buf[2] = STATE_PACKET_VERSION;
+    buf[3] = packet.flags;
+    buf[4] = (uint8_t)(packet.sequence >> 24);
+    buf[5] = (uint8_t)(packet.sequence >> 16);
+    buf[6] = (uint8_t)(packet.sequence >> 8);
+    buf[7] = (uint8_t)(packet.sequence);
+    buf[8] = packet.channel;
+    buf[9] = (uint8_t)packet.deviceType;
+    buf[10] = (uint8_t)packet.deviceNumber;
+    buf[11] = packet.minutes;
+    buf[12] = packet.seconds;
+    buf[13] = packet.tenths;
+    buf[14] = packet.homeScore;
+    buf[15] = packet.awayScore;
+    buf[16] = packet.phase;
+    buf[17] = 0;
+    buf[18] = (uint8_t)(packet.bootId >> 24);
+    buf[19] = (uint8_t)(packet.bootId >> 16);
+    buf[20] = (uint8_t)(packet.bootId >> 8);
+    buf[21] = (uint8_t)(packet.bootId);
+    buf[22] = packet.shotMinutes;
+    buf[23] = packet.shotSeconds;
+    buf[24] = packet.shotFlags;
+    return STATE_PACKET_SIZE;
+}
+
+// Returns false for anything that isn't a state packet we understand
+inline bool decodeStatePacket(const uint8_t* buf, size_t length, StatePacket& packet) {
+    if (length < STATE_PACKET_V1_SIZE) return false;
+    if (buf[0] != STATE_PACKET_MAGIC_0 || buf[1] != STATE_PACKET_MAGIC_1) return false;
+    if (buf[2] < 1) return false;
+
+    packet.version = buf[2];
+    packet.flags = buf[3];
+    packet.sequence = ((uint32_t)buf[4] << 24) | ((uint32_t)buf[5] << 16) |
+                      ((uint32_t)buf[6] << 8) | (uint32_t)buf[7];
+    packet.channel = buf[8];
+    packet.deviceType = (char)buf[9];
+    packet.deviceNumber = (char)buf[10];
+    packet.minutes = buf[11];
+    packet.seconds = buf[12];
+    packet.tenths = buf[13];
+    packet.homeScore = buf[14];
+    packet.awayScore = buf[15];
+    packet.phase = buf[16];
+    packet.bootId = ((uint32_t)buf[18] << 24) | ((uint32_t)buf[19] << 16) |
+                    ((uint32_t)buf[20] << 8) | (uint32_t)buf[21];
+
+    // Version 1 bridges have no shot clock
+    packet.shotMinutes = 0;
+    packet.shotSeconds = 0;
+    packet.shotFlags = 0;
+    if (packet.version >= 2 && length >= STATE_PACKET_SIZE) {
+        packet.shotMinutes = buf[22];
+        packet.shotSeconds = buf[23];
+        packet.shotFlags = buf[24];
+    }
+    return true;
+}
+
+#endif // STATE_PACKET_H
@@ -0,0 +1,110 @@
+// The bridge's path from an accepted game clock frame to the state message and multicast packet,
+// up to where the sockets take over: change check, game events, state JSON, packet. SerialHandler
+// runs every game clock frame through runStatePipeline() and every broadcast slot through
+// broadcastState().
+// scoreboard_bench --check-allocs and the frame_pipeline case on /bench call the same functions.
+// Plain C++ with no Arduino dependencies, like FrameDecoder.h.
+#ifndef STATE_PIPELINE_H
+#define STATE_PIPELINE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "FrameDecoder.h"
+#include "GameEvents.h"
+#include "StateJson.h"
+#include "StatePacket.h"
+
+// What the pipeline carries from one frame to the next
+struct StatePipelineState {
+    ScoreFrame current;     // Latest game clock frame
+    ScoreFrame previous;    // The state as of the last change
+    uint32_t sequence = 0;  // Incremented each time a changed state is published, heartbeats repeat it
+    bool eventsPrimed = false;  // The first frame is the starting state, events come from changes after it
+};
+
+// Where the pipeline hands off. SerialHandler sends to the sockets and the multicast group,
+// the benchmarks keep the results.
+class StatePipelineOutput {
+public:
+    // A frame changed the state. state.previous still holds the state before it.
+    virtual void stateChanged(const StatePipelineState& state, uint32_t arrivalUs) = 0;
+
+    // Goals, clock start/stop and the rest, in the order they happened
+    virtual void gameEvent(GameEvent& event) = 0;
+
+    // True if a state message should go out now. newState is false for a heartbeat.
+    virtual bool isBroadcastDue(bool& newState) = 0;
+
+    // Adds what the frame doesn't carry: timestamps, shot clock, backup flag, game phase
+    virtual void describeState(StateJsonFields& fields, StatePacket& packet) = 0;
+
+    virtual void sendState(const char* json, size_t length, const StatePacket& packet, bool newState) = 0;
+};
+
+// "12" -> 12, for the fixed two-digit fields of a frame
+inline int twoDigitValue(const char* digits) {
+    return (digits[0] - '0') * 10 + (digits[1] - '0');
+}
+
+// The clock and score part of a multicast packet
+inline void fillStatePacket(StatePacket& packet, const ScoreFrame& frame, uint32_t sequence) {
+    packet.flags = frame.deviceType == 'T' ? STATE_FLAG_RUNNING : 0;
+    packet.sequence = sequence;
+    packet.channel = (uint8_t)frame.channel;
+    packet.deviceType = frame.deviceType;
+    packet.deviceNumber = frame.deviceNumber;
+    packet.minutes = (uint8_t)twoDigitValue(frame.timeFormatted);
+    packet.seconds = (uint8_t)twoDigitValue(frame.timeFormatted + 3);
+    packet.tenths = (uint8_t)(frame.subSecond[0] - '0');
+    packet.homeScore = (uint8_t)twoDigitValue(frame.homeScore);
+    packet.awayScore = (uint8_t)twoDigitValue(frame.awayScore);
+}
+
+// The state message and packet for the current state. The message is formatted on the stack.
+inline void sendPipelineState(StatePipelineState& state, StatePipelineOutput& output, bool newState) {
+    if (!isScoreFrameValid(state.current)) return;
+
+    StateJsonFields fields;
+    fields.sequence = state.sequence;
+    StatePacket packet;
+    fillStatePacket(packet, state.current, state.sequence);
+    output.describeState(fields, packet);
+
+    char json[STATE_JSON_CAPACITY];
+    size_t length = formatStateJson(json, sizeof(json), state.current, fields);
+    if (length > 0) output.sendState(json, length, packet, newState);
+}
+
+// One broadcast slot: the latest change, or a heartbeat, if the output says one is due
+inline void broadcastState(StatePipelineState& state, StatePipelineOutput& output) {
+    bool newState = false;
+    if (!output.isBroadcastDue(newState)) return;
+    if (newState) state.sequence++;
+    sendPipelineState(state, output, newState);
+}
+
+// One game clock frame. Returns true if it changed the state.
+inline bool runStatePipeline(StatePipelineState& state, const ScoreFrame& frame, uint32_t arrivalUs,
+                             bool tracksTenths, StatePipelineOutput& output) {
+    state.current = frame;
+    if (!hasScoreFrameChanged(state.current, state.previous, tracksTenths)) return false;
+
+    output.stateChanged(state, arrivalUs);
+
+    if (state.eventsPrimed) {
+        GameEvent events[MAX_GAME_EVENTS_PER_FRAME];
+        int count = detectGameEvents(state.previous, state.current, events, MAX_GAME_EVENTS_PER_FRAME);
+        for (int i = 0; i < count; i++) {
+            events[i].arrivalUs = arrivalUs;
+            output.gameEvent(events[i]);
+        }
+    }
+    state.eventsPrimed = true;
+    state.previous = state.current;
+
+    // Score changes and clock start/stop go out right away, the rest waits for its slot
+    broadcastState(state, output);
+    return true;
+}
+
+#endif // STATE_PIPELINE_H
@@ -0,0 +1,129 @@
+#ifndef STATE_RESTORE_H
+#define STATE_RESTORE_H
+
+#include <Arduino.h>
+#include <Preferences.h>
+#include "FrameDecoder.h"
+
+extern Preferences preferences;
+
+// Keeps the last valid game state, its sequence number and the working baud rates across a
+// restart, so the screen and the first clients show the real score straight after boot instead
+// of 00:00 and 00 - 00 until the console sends again.
+// RTC memory survives a software, watchdog or panic restart and is always current. A throttled
+// NVS copy covers power loss and brownouts.
+
+static const uint8_t RESTORE_SOURCE_COUNT = 2;
+static const char* const STATE_RESTORE_KEY = "lastState";  // NVS copy
+
+struct RetainedState {
+    uint32_t magic;
+    uint8_t frame[sizeof(ScoreFrame)];  // Raw bytes: a ScoreFrame member would be reset by its constructor at boot
+    uint32_t sequence;
+    int8_t baudIndex[RESTORE_SOURCE_COUNT];
+    uint32_t checksum;
+};
+RTC_NOINIT_ATTR RetainedState retainedState;
+
+// What restore() hands back
+struct RestoredState {
+    ScoreFrame frame;
+    uint32_t sequence;
+    int8_t baudIndex[RESTORE_SOURCE_COUNT];
+    bool fromRtc;
+};
+
+class StateRestore {
+private:
+    static const uint32_t MAGIC = 0x53434f52;                 // "SCOR"
+    static const unsigned long SCORE_SAVE_INTERVAL = 5000;    // A score change reaches NVS within this
+    static const unsigned long SAVE_INTERVAL = 60000;         // Clock and sequence only
+    static const uint32_t SEQUENCE_GAP = 1024;                // More than can go out between two NVS saves
+
+    bool dirty = false;
+    bool scoreDirty = false;
+    unsigned long lastSave = 0;
+
+    static uint32_t checksumOf(const RetainedState& state) {
+        const uint8_t* bytes = (const uint8_t*)&state;
+        uint32_t hash = 2166136261u;
+        for (size_t i = 0; i < offsetof(RetainedState, checksum); i++) hash = (hash ^ bytes[i]) * 16777619u;
+        return hash;
+    }
+
+    static bool isValid(const RetainedState& state) {
+        if (state.magic != MAGIC || state.checksum != checksumOf(state)) return false;
+        ScoreFrame frame;
+        memcpy(&frame, state.frame, sizeof(frame));
+        return isScoreFrameValid(frame);
+    }
+
+    void seal() {
+        retainedState.checksum = checksumOf(retainedState);
+        dirty = true;
+    }
+
+public:
+    StateRestore() {}
+
+    // Call once after preferences.begin(), before anything writes state
+    bool restore(RestoredState& out) {
+        RetainedState saved;
+        bool fromRtc = isValid(retainedState);
+        if (fromRtc) {
+            saved = retainedState;
+        } else if (preferences.getBytes(STATE_RESTORE_KEY, &saved, sizeof(saved)) != sizeof(saved) || !isValid(saved)) {
+            // Nothing to restore, start the RTC copy afresh. It stays invalid until the first real frame.
+            memset(&retainedState, 0, sizeof(retainedState));
+            for (uint8_t i = 0; i < RESTORE_SOURCE_COUNT; i++) retainedState.baudIndex[i] = -1;
+            return false;
+        }
+
+        memcpy(&out.frame, saved.frame, sizeof(out.frame));
+        // The NVS copy can be behind: skip past anything that went out after it was saved
+        out.sequence = fromRtc ? saved.sequence : saved.sequence + SEQUENCE_GAP;
+        memcpy(out.baudIndex, saved.baudIndex, sizeof(out.baudIndex));
+        out.fromRtc = fromRtc;
+
+        retainedState = saved;
+        retainedState.sequence = out.sequence;
+        seal();
+        return true;
+    }
+
+    // Each accepted game clock change
+    void noteFrame(const ScoreFrame& frame) {
+        ScoreFrame saved;
+        memcpy(&saved, retainedState.frame, sizeof(saved));
+        if (hasScoreFrameScoreChanged(frame, saved)) scoreDirty = true;
+        memcpy(retainedState.frame, &frame, sizeof(frame));
+        retainedState.magic = MAGIC;
+        seal();
+    }
+
+    void noteSequence(uint32_t sequence) {
+        retainedState.sequence = sequence;
+        seal();
+    }
+
+    void noteBaud(uint8_t source, int baudIndex) {
+        if (source >= RESTORE_SOURCE_COUNT || retainedState.baudIndex[source] == baudIndex) return;
+        retainedState.baudIndex[source] = (int8_t)baudIndex;
+        seal();
+    }
+
+    // Call from loop(): copies the RTC state to NVS, soon after a score change, otherwise once a minute
+    void update() {
+        if (!dirty || !isValid(retainedState)) return;
+        unsigned long now = millis();
+        if (now - lastSave < (scoreDirty ? SCORE_SAVE_INTERVAL : SAVE_INTERVAL)) return;
+        preferences.putBytes(STATE_RESTORE_KEY, &retainedState, sizeof(retainedState));
+        lastSave = now;
+        dirty = false;
+        scoreDirty = false;
+    }
+};
+
+extern StateRestore stateRestore;
+
+#endif // STATE_RESTORE_H
@@ -0,0 +1,163 @@
+#ifndef STATE_SNAPSHOT_H
+#define STATE_SNAPSHOT_H
+
+#include <Arduino.h>
+#include <ESPAsyncWebServer.h>
+#include "StateJson.h"
+
+// The latest state message for clients that can only poll HTTP, served from /api/state.
+// The ETag is the state sequence number, so a poll with a current If-None-Match gets a bare 304.
+// With ?wait=<seconds> that poll is held until the state changes or the wait runs out.
+class StateSnapshot {
+private:
+    static const uint8_t MAX_WAITERS = 8;
+    static const uint32_t MAX_WAIT_S = 30;
+
+    struct Waiter {
+        AsyncWebServerRequest* request;
+        uint32_t sequence;      // The state the client already has
+        unsigned long start;
+        unsigned long waitMs;
+    };
+
+    // Written by the loop task, copied out by the async_tcp task
+    char buffer[STATE_JSON_CAPACITY];
+    size_t length = 0;
+    uint32_t sequence = 0;
+    portMUX_TYPE lock = portMUX_INITIALIZER_UNLOCKED;
+
+    // Held polls, only ever touched on the async_tcp task: added by the route, answered from
+    // the client's poll callback, dropped on disconnect. So no request is sent to or freed
+    // from two tasks at once.
+    Waiter waiters[MAX_WAITERS];
+    uint8_t waiterCount = 0;
+
+    static void formatEtag(char* etag, size_t size, uint32_t value) {
+        snprintf(etag, size, "\"%lu\"", (unsigned long)value);
+    }
+
+    // Quoted tags can be searched for as is, also in a list or with a W/ prefix
+    static bool etagMatches(AsyncWebServerRequest* request, const char* etag) {
+        if (!request->hasHeader("If-None-Match")) return false;
+        const String& value = request->getHeader("If-None-Match")->value();
+        return value == "*" || value.indexOf(etag) >= 0;
+    }
+
+    void sendNotModified(AsyncWebServerRequest* request, const char* etag) {
+        AsyncWebServerResponse* response = request->beginResponse(304, "application/json", "");
+        response->addHeader("ETag", etag);
+        response->addHeader("Cache-Control", "no-cache");
+        request->send(response);
+    }
+
+    void sendState(AsyncWebServerRequest* request) {
+        char copy[STATE_JSON_CAPACITY];
+        char etag[16];
+        portENTER_CRITICAL(&lock);
+        memcpy(copy, buffer, length + 1);
+        formatEtag(etag, sizeof(etag), sequence);
+        portEXIT_CRITICAL(&lock);
+
+        AsyncWebServerResponse* response = request->beginResponse(200, "application/json", copy);
+        response->addHeader("ETag", etag);
+        response->addHeader("Cache-Control", "no-cache");
+        request->send(response);
+    }
+
+    int findWaiter(AsyncWebServerRequest* request) {
+        for (uint8_t i = 0; i < waiterCount; i++) {
+            if (waiters[i].request == request) return i;
+        }
+        return -1;
+    }
+
+    void removeWaiter(AsyncWebServerRequest* request) {
+        int i = findWaiter(request);
+        if (i >= 0) waiters[i] = waiters[--waiterCount];
+    }
+
+    // async_tcp task, from the client's poll callback (about twice a second)
+    void pollWaiter(AsyncWebServerRequest* request) {
+        int i = findWaiter(request);
+        if (i < 0) return; // Already answered
+
+        char etag[16];
+        portENTER_CRITICAL(&lock);
+        uint32_t current = sequence;
+        portEXIT_CRITICAL(&lock);
+
+        if (current != waiters[i].sequence) {
+            removeWaiter(request);
+            sendState(request);
+        } else if (millis() - waiters[i].start >= waiters[i].waitMs) {
+            removeWaiter(request);
+            formatEtag(etag, sizeof(etag), current);
+            sendNotModified(request, etag);
+        }
+    }
+
+public:
+    StateSnapshot() {
+        buffer[0] = '\0';
+    }
+
+    // Loop task, once per new state. Only the copy is updated here, held polls notice the
+    // new sequence on their own.
+    void publish(const char* json, size_t jsonLength, uint32_t stateSequence) {
+        if (jsonLength >= sizeof(buffer)) return;
+        portENTER_CRITICAL(&lock);
+        memcpy(buffer, json, jsonLength);
+        buffer[jsonLength] = '\0';
+        length = jsonLength;
+        sequence = stateSequence;
+        portEXIT_CRITICAL(&lock);
+    }
+
+    // async_tcp task, from the /api/state route
+    void handleRequest(AsyncWebServerRequest* request) {
+        char etag[16];
+        portENTER_CRITICAL(&lock);
+        uint32_t current = sequence;
+        portEXIT_CRITICAL(&lock);
+        formatEtag(etag, sizeof(etag), current);
+
+        if (current == 0) {
+            request->send(503, "application/json", "{\"status\":\"no state yet\"}");
+            return;
+        }
+        if (!etagMatches(request, etag)) {
+            sendState(request);
+            return;
+        }
+
+        uint32_t waitS = request->hasParam("wait") ? request->getParam("wait")->value().toInt() : 0;
+        if (waitS > MAX_WAIT_S) waitS = MAX_WAIT_S;
+        if (waitS == 0 || waiterCount >= MAX_WAITERS) {
+            sendNotModified(request, etag);
+            return;
+        }
+
+        waiters[waiterCount].request = request;
+        waiters[waiterCount].sequence = current;
+        waiters[waiterCount].start = millis();
+        waiters[waiterCount].waitMs = waitS * 1000UL;
+        waiterCount++;
+        request->onDisconnect([this, request]() {
+            removeWaiter(request);
+        });
+        // A held request has no response yet, so its own poll handler has nothing to do.
+        // The answer is small enough to go out in one write, the rest is driven by acks.
+        request->client()->onPoll([this, request](void*, AsyncClient*) {
+            pollWaiter(request);
+        }, nullptr);
+    }
+};
+
+extern StateSnapshot stateSnapshot;
+
+// Used by the /api/state route in WebRoutes.h
+void handleStateRequest(AsyncWebServerRequest* request) {
+    stateSnapshot.handleRequest(request);
+}
+
+#endif // STATE_SNAPSHOT_H
@@ -0,0 +1,305 @@
+#ifndef UART_SOURCE_H
+#define UART_SOURCE_H
+
+#include <Arduino.h>
+#include "FrameDecoder.h"
+#include "LoopWake.h"
+#include "Parameters.h"
+
+// What a console input feeds into the merged state
+enum SourceRole {
+    SOURCE_DISABLED,
+    SOURCE_MAIN,        // Game clock, scores, channel
+    SOURCE_SHOT_CLOCK,  // Shot/possession clock controller, only its time field is used
+    SOURCE_BACKUP       // Second game clock console, used while the main one is silent
+};
+
+enum SourceHealth {
+    SOURCE_HEALTH_OFF,       // Port not started
+    SOURCE_HEALTH_SILENT,    // No bytes recently
+    SOURCE_HEALTH_GARBLED,   // Bytes but no valid frames - wrong baud rate or wiring
+    SOURCE_HEALTH_OK
+};
+
+static const char* const SOURCE_ROLE_NAMES[] = {"disabled", "main", "shotClock", "backup"};
+static const char* const SOURCE_HEALTH_NAMES[] = {"off", "silent", "garbled", "ok"};
+
+// One console input: a UART with its own frame assembly, baud detection and health counters.
+// SerialHandler decodes what it assembles and merges the sources into one state.
+class UartSource {
+public:
+    static const int MAX_MESSAGE_LENGTH = MESSAGE_LENGTH_LIMIT;  // Buffer size, the frame limit itself is a parameter
+    static const int MIN_MESSAGE_LENGTH = 13;
+    static const unsigned long HEALTH_TIMEOUT = 5000;   // No bytes/frames for this long is unhealthy
+    static const size_t RX_BUFFER_SIZE = 1024;
+
+private:
+    HardwareSerial& port;
+    const char* name;
+    int8_t rxPin;
+    int8_t txPin;
+    SourceRole role;
+    bool started = false;
+
+    // Frame assembly
+    char message[MAX_MESSAGE_LENGTH];
+    unsigned int message_pos = 0;
+    bool messageReady = false;
+    unsigned long lastByteTime = 0;
+
+    // Latency tracing, micros(): when the driver last reported bytes and when this frame arrived
+    volatile uint32_t rxEventUs = 0;
+    uint32_t frameArrivalUs = 0;
+
+    // Baud rate detection, an index into BAUD_RATE_TABLE
+    int baudIndex = 0;
+    int goodBaudIndex = -1;  // Rate the last valid frame came in at, kept across restarts by StateRestore
+    unsigned long lastBaudChange = 0;
+    int failedAttempts = 0;
+
+    // Last valid frame from this source
+    ScoreFrame frame;
+    uint32_t frameUs = 0;
+    unsigned long lastValidDataTime = 0;
+
+    // Health counters
+    unsigned long bytesReceived = 0;
+    unsigned long framesDecoded = 0;
+    unsigned long framesRejected = 0;
+    unsigned long shortMessages = 0;
+
+    void clearBuffer() {
+        message_pos = 0;
+        messageReady = false;
+        memset(message, 0, MAX_MESSAGE_LENGTH);
+    }
+
+    // Use the driver's receive time if it fired for this frame, otherwise now
+    uint32_t stampFrameArrival() {
+        uint32_t now = micros();
+        uint32_t event = rxEventUs;
+        if (event != frameArrivalUs && now - event < parameters.get(PARAM_BYTE_TIMEOUT) * 1000UL) return event;
+        return now;
+    }
+
+    void openPort() {
+        port.setRxBufferSize(RX_BUFFER_SIZE);
+        port.begin(BAUD_RATE_TABLE[baudIndex], SERIAL_8N1, rxPin, txPin);
+        port.setTimeout(50);
+        // Runs on the UART event task once a frame has landed
+        port.onReceive([this]() {
+            rxEventUs = micros();
+            wakeLoop(); // End the loop's idle wait
+        });
+    }
+
+public:
+    UartSource(HardwareSerial& serialPort, const char* sourceName, int8_t rx, int8_t tx, SourceRole sourceRole)
+        : port(serialPort), name(sourceName), rxPin(rx), txPin(tx), role(sourceRole) {
+        clearBuffer();
+    }
+
+    bool begin() {
+        if (role == SOURCE_DISABLED) return true;
+
+        // Restarting an open port: give the driver time to release it and drop stale bytes.
+        // On the first start there is nothing stale, so keep every byte from power-on.
+        bool restart = started;
+        if (restart) {
+            port.end();
+            delay(100);
+        }
+
+        // Room for a few seconds of frames while the rest of the system boots
+        // The rate that last worked, otherwise the lowest enabled one - detectBaudRate() moves on from there
+        bool goodBaud = goodBaudIndex >= 0 && goodBaudIndex < BAUD_RATE_TABLE_SIZE && parameters.isBaudEnabled(goodBaudIndex);
+        baudIndex = goodBaud ? goodBaudIndex : parameters.firstBaudIndex();
+        openPort();
+        started = true;
+
+        unsigned long startTime = millis();
+        while (!port && (millis() - startTime < 1000)) {
+            delay(10);
+        }
+
+        if (restart) {
+            // Flush any leftover data
+            while (port.available()) {
+                port.read();
+            }
+            clearBuffer();
+        }
+
+        return port;
+    }
+
+    void end() {
+        if (!started) return;
+        port.end();
+        started = false;
+        clearBuffer();
+    }
+
+    void setRole(SourceRole newRole) {
+        if (newRole == role) return;
+        role = newRole;
+        if (role == SOURCE_DISABLED) {
+            end();
+        } else if (!started) {
+            begin();
+        }
+    }
+
+    // Cycles through the enabled baud rates while no valid frames arrive.
+    // Returns the new rate, or 0 if nothing changed.
+    long detectBaudRate() {
+        if (!started) return 0;
+
+        // If we've received valid data recently (within 60 seconds), don't change baud rate
+        if (millis() - lastValidDataTime < 60000) {
+            failedAttempts = 0; // Reset failure counter when we're getting valid data
+            return 0;
+        }
+
+        // Only try changing baud rate every 15 seconds
+        if (millis() - lastBaudChange < 15000) return 0;
+
+        // Data is flowing at this rate, give the decoder a chance
+        if (port.available() != 0) return 0;
+
+        // If we've cycled through all baud rates multiple times with no success
+        // and haven't received valid data in 2 minutes, go back to default
+        if (failedAttempts > 10 && millis() - lastValidDataTime > 120000) {
+            baudIndex = parameters.firstBaudIndex(); // Back to the lowest enabled rate
+            failedAttempts = 0;
+        } else {
+            baudIndex = parameters.nextBaudIndex(baudIndex);
+            failedAttempts++;
+        }
+
+        port.end();
+        delay(100);
+        openPort();
+        clearBuffer();
+        lastBaudChange = millis();
+        return BAUD_RATE_TABLE[baudIndex];
+    }
+
+    // Call until it returns false. True means a complete message is waiting in getMessage();
+    // call consumeMessage() once it has been handled.
+    bool poll(unsigned long currentTime) {
+        if (!started) return false;
+        if (messageReady) return true;
+        unsigned int maxLength = parameters.get(PARAM_MAX_MESSAGE_LENGTH);
+
+        // Process data in chunks if enough is available
+        if (port.available() >= MIN_MESSAGE_LENGTH) { // We need at least a complete message
+            clearBuffer();
+            frameArrivalUs = stampFrameArrival();
+            unsigned long readStart = millis();
+
+            // Read up to a complete message
+            while (port.available() > 0 && message_pos < maxLength - 1 &&
+                   (millis() - readStart < 50)) { // 50ms max reading time
+                message[message_pos++] = port.read();
+            }
+            bytesReceived += message_pos;
+            lastByteTime = currentTime;
+            message[message_pos] = '\0';
+
+            if (message_pos >= MIN_MESSAGE_LENGTH) {
+                messageReady = true;
+                return true;
+            }
+        }
+
+        // Check for timeout on any remaining partial data
+        if (message_pos > 0 && (currentTime - lastByteTime > parameters.get(PARAM_BYTE_TIMEOUT))) {
+            message[message_pos] = '\0';
+
+            // Only process complete messages
+            if (message_pos >= MIN_MESSAGE_LENGTH) {
+                messageReady = true;
+                return true;
+            }
+            shortMessages++;
+            clearBuffer();
+        }
+
+        // Read any additional bytes (if not enough for a chunk)
+        while (port.available() > 0 && message_pos < maxLength - 1) {
+            if (message_pos == 0) frameArrivalUs = stampFrameArrival();
+            message[message_pos++] = port.read();
+            bytesReceived++;
+            lastByteTime = currentTime;
+        }
+        return false;
+    }
+
+    const char* getMessage() const { return message; }
+    int getMessageLength() const { return message_pos; }
+    uint32_t getMessageArrivalUs() const { return frameArrivalUs; }
+
+    void consumeMessage() {
+        clearBuffer();
+    }
+
+    // Drops the partial frame and whatever the driver has buffered. Returns the bytes dropped.
+    size_t flush() {
+        size_t dropped = message_pos;
+        clearBuffer();
+        if (!started) return dropped;
+        for (size_t i = 0; i < RX_BUFFER_SIZE && port.available() > 0; i++) {
+            port.read();
+            dropped++;
+        }
+        return dropped;
+    }
+
+    // Results of decoding the current message
+    void acceptFrame(const ScoreFrame& decoded) {
+        frame = decoded;
+        frameUs = frameArrivalUs;
+        lastValidDataTime = millis();
+        framesDecoded++;
+        goodBaudIndex = baudIndex;
+    }
+
+    void rejectFrame() {
+        framesRejected++;
+    }
+
+    const ScoreFrame& getFrame() const { return frame; }
+    uint32_t getFrameArrivalUs() const { return frameUs; }
+
+    bool hasReceivedValidData(unsigned long timeout) const {
+        return framesDecoded > 0 && millis() - lastValidDataTime < timeout;
+    }
+
+    SourceHealth getHealth() const {
+        if (!started) return SOURCE_HEALTH_OFF;
+        if (hasReceivedValidData(HEALTH_TIMEOUT)) return SOURCE_HEALTH_OK;
+        if (bytesReceived > 0 && millis() - lastByteTime < HEALTH_TIMEOUT) return SOURCE_HEALTH_GARBLED;
+        return SOURCE_HEALTH_SILENT;
+    }
+
+    bool isStarted() const { return started; }
+    bool hasPartialMessage() const { return message_pos > 0; }
+    const char* getName() const { return name; }
+    SourceRole getRole() const { return role; }
+    int8_t getRxPin() const { return rxPin; }
+    int8_t getTxPin() const { return txPin; }
+    long getBaudRate() const { return BAUD_RATE_TABLE[baudIndex]; }
+    int getGoodBaudIndex() const { return goodBaudIndex; }
+    void setGoodBaudIndex(int index) { goodBaudIndex = index; } // Before begin()
+    int available() { return started ? port.available() : 0; }
+    unsigned long getLastByteTime() const { return lastByteTime; }
+    uint32_t getRxEventUs() const { return rxEventUs; }
+    unsigned long getLastValidDataTime() const { return lastValidDataTime; }
+    unsigned long getBytesReceived() const { return bytesReceived; }
+    unsigned long getFramesDecoded() const { return framesDecoded; }
+    unsigned long getFramesRejected() const { return framesRejected; }
+    unsigned long getShortMessages() const { return shortMessages; }
+};
+
+#endif // UART_SOURCE_H
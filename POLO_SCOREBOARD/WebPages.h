@@ -1,6 +1,194 @@
 #ifndef WEB_PAGES_H
 #define WEB_PAGES_H
 
+// Shared /ws connection, served as /ws-shared.js. Loaded by every page and also run as the SharedWorker.
+// Pages create a SharedSocket where they would create a WebSocket (same readyState, send, close and
+// on* handlers), and all open pages in a browser share one real socket. That socket lives in a
+// SharedWorker, or where there are none (Android Chrome) in whichever page holds a Web Lock, which
+// relays to the others over a BroadcastChannel. Without either each page opens its own as before.
+// Pages use `new (window.SharedSocket || WebSocket)(url)`, so a page whose copy of this script
+// didn't load still connects on its own socket.
+const char WS_SHARED_JS[] PROGMEM = R"(
+(function() {
+    var NAME = `scoreboard-ws`;
+    var OPEN = 1;
+    var CLOSED = 3;
+
+    // Owns the real socket. deliver(id, message) reaches one page, or every page when id is null.
+    function SocketHub(deliver) {
+        var socket = null;
+        var clients = {};
+        var syncOwners = {}; // timeSync t0 -> page, a reply only makes sense to the page that asked
+
+        function open(url) {
+            socket = new WebSocket(url);
+            socket.onopen = function() {
+                deliver(null, {event: `open`});
+            };
+            socket.onclose = function() {
+                socket = null;
+                clients = {};
+                syncOwners = {};
+                deliver(null, {event: `close`}); // Pages reconnect with their own back-off
+            };
+            socket.onmessage = function(e) {
+                if (typeof e.data === `string` && e.data.indexOf(`"type":"timeSync"`) >= 0) {
+                    var t0 = JSON.parse(e.data).t0;
+                    var owner = syncOwners[t0];
+                    delete syncOwners[t0];
+                    if (owner !== undefined) deliver(owner, {event: `message`, data: e.data});
+                    return;
+                }
+                deliver(null, {event: `message`, data: e.data});
+            };
+        }
+
+        this.handle = function(id, message) {
+            if (message.op === `connect`) {
+                clients[id] = true;
+                if (!socket) open(message.url);
+                else if (socket.readyState === OPEN) deliver(id, {event: `open`});
+            } else if (message.op === `send`) {
+                if (!socket || socket.readyState !== OPEN) return;
+                if (message.data.indexOf(`"type":"timeSync"`) >= 0) {
+                    if (Object.keys(syncOwners).length > 64) syncOwners = {}; // Requests the bridge never answered
+                    syncOwners[JSON.parse(message.data).t0] = id;
+                }
+                socket.send(message.data);
+            } else if (message.op === `leave`) {
+                delete clients[id];
+                if (socket && Object.keys(clients).length === 0) {
+                    socket.onclose = null;
+                    socket.close();
+                    socket = null;
+                    syncOwners = {};
+                }
+            }
+        };
+    }
+
+    // Running as the SharedWorker: one port per page
+    if (typeof window === `undefined`) {
+        var ports = [];
+        var workerHub = new SocketHub(function(id, message) {
+            if (id !== null) {
+                ports[id].postMessage(message);
+                return;
+            }
+            for (var i = 0; i < ports.length; i++) ports[i].postMessage(message);
+        });
+        self.onconnect = function(e) {
+            var id = ports.length;
+            ports.push(e.ports[0]);
+            e.ports[0].onmessage = function(m) { workerHub.handle(id, m.data); };
+        };
+        return;
+    }
+
+    var pageId = Math.random().toString(36).slice(2);
+    var current = null; // This page's SharedSocket, a page has one connection
+    var post;           // Sends an op to the hub
+
+    function dispatch(message) {
+        if (current) current.receive(message);
+    }
+
+    function reconnectCurrent() {
+        if (current && current.readyState !== CLOSED) post({op: `connect`, url: current.url});
+    }
+
+    if (window.SharedWorker) {
+        var worker = new SharedWorker(`/ws-shared.js`, NAME);
+        worker.port.onmessage = function(e) { dispatch(e.data); };
+        post = function(message) { worker.port.postMessage(message); };
+    } else if (window.BroadcastChannel && navigator.locks) {
+        // The lock holder runs the hub. Ops carry from, events carry to (* for every page).
+        var channel = new BroadcastChannel(NAME);
+        var leaderHub = null;
+        channel.onmessage = function(e) {
+            var m = e.data;
+            if (m.op) {
+                if (leaderHub) leaderHub.handle(m.from, m);
+            } else if (m.event === `leader`) {
+                reconnectCurrent(); // The last leader went away with its socket
+            } else if (m.to === `*` || m.to === pageId) {
+                dispatch(m);
+            }
+        };
+        post = function(message) {
+            if (leaderHub) {
+                leaderHub.handle(pageId, message);
+                return;
+            }
+            message.from = pageId;
+            channel.postMessage(message);
+        };
+        navigator.locks.request(NAME, function() {
+            leaderHub = new SocketHub(function(id, message) {
+                if (id === null || id === pageId) dispatch(message);
+                if (id === pageId) return;
+                message.to = id === null ? `*` : id;
+                channel.postMessage(message);
+            });
+            channel.postMessage({event: `leader`});
+            reconnectCurrent();
+            return new Promise(function() {}); // Held until the page goes away
+        });
+    } else {
+        var localHub = new SocketHub(function(id, message) { dispatch(message); });
+        post = function(message) { localHub.handle(pageId, message); };
+    }
+
+    window.addEventListener(`pagehide`, function() {
+        if (current && current.readyState !== CLOSED) post({op: `leave`});
+    });
+    window.addEventListener(`pageshow`, function(e) {
+        if (e.persisted) reconnectCurrent(); // Back from the back-forward cache
+    });
+
+    function SharedSocket(url) {
+        if (current) current.readyState = CLOSED; // Replaced, the connect below takes over
+        this.url = url;
+        this.readyState = 0;
+        this.onopen = null;
+        this.onclose = null;
+        this.onmessage = null;
+        this.onerror = null;
+        current = this;
+        post({op: `connect`, url: url});
+    }
+
+    SharedSocket.prototype.receive = function(message) {
+        if (this.readyState === CLOSED) return;
+        if (message.event === `open`) {
+            // Also after a leader handover, so the page asks for the current state again
+            this.readyState = OPEN;
+            if (this.onopen) this.onopen();
+        } else if (message.event === `close`) {
+            this.readyState = CLOSED;
+            if (this.onclose) this.onclose();
+        } else if (message.event === `message` && this.readyState === OPEN) {
+            if (this.onmessage) this.onmessage({data: message.data});
+        }
+    };
+
+    SharedSocket.prototype.send = function(data) {
+        if (this.readyState === OPEN) post({op: `send`, data: data});
+    };
+
+    // Only this page leaves, the socket stays up for the others
+    SharedSocket.prototype.close = function() {
+        if (this.readyState === CLOSED) return;
+        this.readyState = CLOSED;
+        post({op: `leave`});
+        var socket = this;
+        setTimeout(function() { if (socket.onclose) socket.onclose(); }, 0);
+    };
+
+    window.SharedSocket = SharedSocket;
+})();
+)";
+
 // index page with table display
 const char INDEX_HTML[] PROGMEM = R"(
 <!DOCTYPE html>
@@ -55,6 +243,13 @@ const char INDEX_HTML[] PROGMEM = R"(
             letter-spacing: 0.05em;
             // text-shadow: 0 0 10px rgba(255, 255, 0, 0.5);
         }
+        .shot-clock {
+            font-size: 4vw;
+            font-family: 'Orbitron', monospace;
+            color: #8f8;
+            margin-bottom: 20px;
+        }
+        .shot-clock.stopped { color: #888; }
         .score-table {
             border-collapse: collapse;
             width: 80%;
@@ -103,6 +298,7 @@ const char INDEX_HTML[] PROGMEM = R"(
     
     <div class="scoreboard">
         <div class="time" id="time">00:00</div>
+        <div class="shot-clock" id="shotClock" style="display: none;"></div>
         <table class="score-table">
             <tr>
                 <th>HOME</th>
@@ -118,18 +314,124 @@ const char INDEX_HTML[] PROGMEM = R"(
     <div id="status" class="status">Connecting...</div>
     <div class="footer">Made with love by Face Cage CO. <span id="currentYear"></span></div>
 
+    <script src="/ws-shared.js"></script>
     <script>
         document.getElementById('currentYear').textContent = new Date().getFullYear();
 
-        var wsUrl = `ws://` + location.hostname + `/ws`;
+        var wsUrl = `ws://` + location.host + `/ws`;
         var timeDisplay = document.getElementById(`time`);
         var homeDisplay = document.getElementById(`home`);
         var awayDisplay = document.getElementById(`away`);
         var statusDisplay = document.getElementById(`status`);
+        var shotClockDisplay = document.getElementById(`shotClock`);
         var ws;
         var reconnectAttempts = 0;
         var maxReconnectAttempts = 20; // Try reconnecting ~10 minutes (20 * varies from 5s to 30s)
         var isConnecting = false;
+
+        // Latency tracing: open the page as /?latency to echo each update's stamp back
+        // with the receive and paint times, the bridge collects them at /latency
+        var latencyEcho = new URLSearchParams(location.search).has(`latency`);
+        var lastEchoSeq = -1;
+
+        function echoLatency(data, receivedAt) {
+            if (!latencyEcho || data.ts === undefined || data.seq === lastEchoSeq || document.hidden) return;
+            lastEchoSeq = data.seq;
+            // The frame callback runs before the paint, the timeout right after it
+            requestAnimationFrame(function() {
+                setTimeout(function() {
+                    if (ws && ws.readyState === WebSocket.OPEN) {
+                        ws.send(JSON.stringify({type: `latencyEcho`, seq: data.seq, ts: data.ts,
+                                                recv: receivedAt, paint: performance.now()}));
+                    }
+                }, 0);
+            });
+        }
+
+        // Clock sync: an NTP-style exchange with the bridge every few seconds. Updates carry
+        // their send time "bt" on the bridge's clock and every synced screen shows them at
+        // bt + playout, so clocks change together however long each one's Wi-Fi took.
+        // Until the first exchange, or through a relay that doesn't answer, updates show on arrival.
+        // Times are microseconds mod 2^32 like the bridge's micros().
+        var SYNC_SAMPLES = 8;
+        var clockSync = {samples: [], offsetUs: 0, playoutMs: 0, lastRttUs: 0, timer: null, burst: 0};
+        var lastRenderAt = 0;
+
+        function nowUs() {
+            return Math.floor(performance.now() * 1000) >>> 0;
+        }
+
+        function sendTimeSync() {
+            if (!ws || ws.readyState !== WebSocket.OPEN) return;
+            var request = {type: `timeSync`, t0: nowUs()};
+            if (clockSync.lastRttUs > 0) request.rtt = clockSync.lastRttUs;
+            ws.send(JSON.stringify(request));
+        }
+
+        function startTimeSync() {
+            clockSync.samples = [];
+            clockSync.lastRttUs = 0;
+            clockSync.burst = 0;
+            clearTimeout(clockSync.timer);
+            nextTimeSync();
+        }
+
+        function nextTimeSync() {
+            sendTimeSync();
+            // A quick burst to sync on connect, then keep tracking drift and Wi-Fi changes
+            var delay = clockSync.burst++ < 4 ? 250 : 5000;
+            clockSync.timer = setTimeout(nextTimeSync, delay);
+        }
+
+        function handleTimeSync(data, t3) {
+            var held = (data.t2 - data.t1) >>> 0;
+            var rtt = ((t3 - data.t0) >>> 0) - held;
+            if (rtt < 0 || rtt > 10000000) return;
+            // Offset of the bridge clock from ours, assuming the trip is the same both ways
+            var there = (data.t1 - data.t0) >>> 0;
+            var back = (data.t2 - t3) >>> 0;
+            var offset = (there + Math.round(((back - there) | 0) / 2)) >>> 0;
+
+            clockSync.lastRttUs = rtt;
+            clockSync.playoutMs = data.playout || 0;
+            clockSync.samples.push({rtt: rtt, offset: offset});
+            if (clockSync.samples.length > SYNC_SAMPLES) clockSync.samples.shift();
+            // The fastest recent exchange had the least queueing, trust its offset
+            var best = clockSync.samples[0];
+            for (var i = 1; i < clockSync.samples.length; i++) {
+                if (clockSync.samples[i].rtt < best.rtt) best = clockSync.samples[i];
+            }
+            clockSync.offsetUs = best.offset;
+        }
+
+        // Milliseconds to hold an update so it shows at bt + playout
+        function renderDelay(data) {
+            if (clockSync.samples.length === 0 || data.bt === undefined) return 0;
+            var showAtUs = (data.bt + clockSync.playoutMs * 1000 - clockSync.offsetUs) >>> 0;
+            var delay = ((showAtUs - nowUs()) | 0) / 1000;
+            return Math.min(Math.max(delay, 0), 2000);
+        }
+
+        function renderUpdate(data, receivedAt) {
+            if (data.time) {
+                // Show tenths while the clock runs in the final minute
+                var finalMinute = data.isRunning && data.time.indexOf(`00:`) === 0 && data.tenths !== undefined;
+                timeDisplay.textContent = finalMinute ? data.time + `.` + data.tenths : data.time;
+            }
+            if (data.home) homeDisplay.textContent = data.home;
+            if (data.away) awayDisplay.textContent = data.away;
+            if (data.time) {
+                // Shot clock only when the bridge has a second console in that role
+                if (data.shotClock !== undefined) {
+                    shotClockDisplay.textContent = `SHOT ` + data.shotClock;
+                    shotClockDisplay.classList.toggle(`stopped`, !data.shotRunning);
+                    shotClockDisplay.style.display = ``;
+                } else {
+                    shotClockDisplay.style.display = `none`;
+                }
+                echoLatency(data, receivedAt);
+            }
+        }
         
         function connectWebSocket() {
             if (isConnecting) return; // Prevent multiple connection attempts
@@ -138,7 +440,7 @@ const char INDEX_HTML[] PROGMEM = R"(
             statusDisplay.textContent = `Connecting...`;
             
             // Create new WebSocket connection
-            ws = new WebSocket(wsUrl);
+            ws = new (window.SharedSocket || WebSocket)(wsUrl);
             
             ws.onopen = function() {
                 isConnecting = false;
@@ -148,10 +450,12 @@ const char INDEX_HTML[] PROGMEM = R"(
 
                 // Request current data immediately after connection
                 ws.send(JSON.stringify({command: "getCurrentData"}));
+                startTimeSync();
             };
             
             ws.onclose = function() {
                 isConnecting = false;
+                clearTimeout(clockSync.timer);
                 statusDisplay.textContent = `Disconnected - Retrying in ` + getReconnectDelay()/1000 + `s`;
                 statusDisplay.classList.add(`disconnected`);
                 
@@ -160,11 +464,22 @@ const char INDEX_HTML[] PROGMEM = R"(
             };
             
             ws.onmessage = function(event) {
+                var receivedAt = performance.now();
+                var receivedUs = nowUs();
                 try {
                     var data = JSON.parse(event.data);
-                    if (data.time) timeDisplay.textContent = data.time;
-                    if (data.home) homeDisplay.textContent = data.home;
-                    if (data.away) awayDisplay.textContent = data.away;
+                    if (data.type === `timeSync`) {
+                        handleTimeSync(data, receivedUs);
+                        return;
+                    }
+                    // Never show an update before the one that came ahead of it
+                    var renderAt = Math.max(receivedAt + renderDelay(data), lastRenderAt);
+                    lastRenderAt = renderAt;
+                    if (renderAt - receivedAt < 1) {
+                        renderUpdate(data, receivedAt);
+                    } else {
+                        setTimeout(function() { renderUpdate(data, receivedAt); }, renderAt - receivedAt);
+                    }
                 } catch (e) {
                     console.error(`Error parsing data:`, e);
                 }
@@ -228,23 +543,60 @@ const char DEBUG_HTML[] PROGMEM = R"(
     <style>
         body { font-family: Arial, sans-serif; margin: 20px; background: #1a1a1a; color: #fff; }
         #serialData {
+            position: relative;
             width: 100%;
             height: 400px;
-            margin: 20px 0;
-            padding: 10px;
+            margin: 10px 0;
             border: 1px solid #333;
             overflow-y: scroll;
             font-family: monospace;
             background: #000;
             color: #0f0;
+            box-sizing: border-box;
+        }
+        #spacer { width: 1px; }
+        #rows {
+            position: absolute;
+            left: 0;
+            right: 0;
+            top: 0;
+        }
+        .row {
+            height: 18px;
+            line-height: 18px;
+            padding: 0 10px;
+            white-space: pre;
+            overflow: hidden;
+            text-overflow: ellipsis;
+            cursor: pointer;
+        }
+        .row:hover { background: #111; }
+        #detail {
+            white-space: pre-wrap;
+            word-break: break-all;
+            font-family: monospace;
+            background: #000;
+            border: 1px solid #333;
+            padding: 10px;
+            min-height: 1.2em;
+            color: #ccc;
         }
         .nav { margin-bottom: 20px; }
         .nav a { margin-right: 10px; color: #fff; text-decoration: none; }
-        .controls { margin: 10px 0; }
-        .score { color: #00ffff; font-weight: bold; font-size: 1.2em; }
+        .controls { margin: 10px 0; display: flex; flex-wrap: wrap; gap: 8px; align-items: center; }
+        .controls input[type="text"], .controls select {
+            background: #333;
+            color: #fff;
+            border: 1px solid #555;
+            padding: 6px;
+        }
+        .stats { color: #888; font-size: 0.85em; }
+        .score { color: #00ffff; font-weight: bold; }
         .error { color: #ff4444; }
         .success { color: #4CAF50; }
         .info { color: #00ffff; }
+        .state { color: #fff; }
+        .debug { color: #ffd54f; }
         button { 
             background: #333; 
             color: #fff; 
@@ -253,8 +605,8 @@ const char DEBUG_HTML[] PROGMEM = R"(
             cursor: pointer;
         }
         button:hover { background: #444; }
+        button.active { background: #b71c1c; }
         #reconnect {
-            margin-left: 10px;
             background: #4CAF50;
         }
         #reconnect:hover {
@@ -271,18 +623,243 @@ const char DEBUG_HTML[] PROGMEM = R"(
     <h1>Scoreboard Debug Monitor</h1>
     <div class="controls">
         <button onclick='clearData()'>Clear</button>
+        <button id="pause" onclick='togglePause()'>Pause</button>
+        <button onclick='exportHistory()'>Export</button>
+        <input type="text" id="filter" placeholder="Filter" oninput='setFilter()'>
+        <select id="kind" onchange='setFilter()'>
+            <option value="">All messages</option>
+            <option value="state">State updates</option>
+            <option value="debug">Debug</option>
+            <option value="connection">Connection</option>
+        </select>
         <label><input type="checkbox" id="autoscroll" checked> Auto-scroll</label>
         <button id="reconnect" onclick='manualReconnect()'>Reconnect</button>
     </div>
-    <div id="serialData"></div>
+    <div id="stats" class="stats"></div>
+    <div id="serialData"><div id="spacer"></div><div id="rows"></div></div>
+    <div id="detail" class="stats">Click a line to see all of it</div>
+    <script src="/ws-shared.js"></script>
     <script>
-        var wsUrl = `ws://` + location.hostname + `/ws`;
+        var wsUrl = `ws://` + location.host + `/ws`;
         var serialDiv = document.getElementById(`serialData`);
+        var spacer = document.getElementById(`spacer`);
+        var rowsDiv = document.getElementById(`rows`);
+        var statsDiv = document.getElementById(`stats`);
+        var detailDiv = document.getElementById(`detail`);
         var autoscroll = document.getElementById(`autoscroll`);
         var ws;
         var reconnectAttempts = 0;
         var isConnecting = false;
         var reconnectTimer = null;
+
+        // History: a fixed ring of the latest messages, so a page left open all match
+        // uses the same memory after ten minutes as after two hours
+        var CAPACITY = 5000;
+        var ROW_HEIGHT = 18;
+        var ringTime = new Array(CAPACITY);
+        var ringText = new Array(CAPACITY);
+        var ringClass = new Array(CAPACITY);
+        var total = 0; // Messages ever added, the sequence number of the next one
+
+        // Sequence numbers of the messages that pass the filter, oldest first
+        var shown = [];
+        var shownStart = 0;
+        var filterText = ``;
+        var filterKind = ``;
+        var paused = false;
+        var pausedCount = 0;
+
+        var renderPending = false;
+        var rowPool = [];
+        var rateCount = 0;
+        var rate = 0;
+
+        // Latency tracing: open as /debug?latency to echo state updates back to the bridge
+        var latencyEcho = new URLSearchParams(location.search).has(`latency`);
+        var lastEchoSeq = -1;
+
+        function echoLatency(text, receivedAt) {
+            if (!latencyEcho || document.hidden || text.charAt(0) !== `{`) return;
+            var data;
+            try { data = JSON.parse(text); } catch (e) { return; }
+            if (data.ts === undefined || data.seq === lastEchoSeq) return;
+            lastEchoSeq = data.seq;
+            requestAnimationFrame(function() {
+                setTimeout(function() {
+                    if (ws && ws.readyState === WebSocket.OPEN) {
+                        ws.send(JSON.stringify({type: `latencyEcho`, seq: data.seq, ts: data.ts,
+                                                recv: receivedAt, paint: performance.now()}));
+                    }
+                }, 0);
+            });
+        }
+
+        function oldestSeq() {
+            return total > CAPACITY ? total - CAPACITY : 0;
+        }
+
+        function kindOf(className) {
+            if (className === `state` || className === `score`) return `state`;
+            if (className === `debug`) return `debug`;
+            return `connection`;
+        }
+
+        function matches(seq) {
+            var slot = seq % CAPACITY;
+            if (filterKind && kindOf(ringClass[slot]) !== filterKind) return false;
+            return !filterText || ringText[slot].toLowerCase().indexOf(filterText) >= 0;
+        }
+
+        // Only stores the message, the screen catches up once per animation frame
+        function appendMessage(message, className) {
+            var seq = total++;
+            var slot = seq % CAPACITY;
+            ringTime[slot] = Date.now();
+            ringText[slot] = String(message);
+            ringClass[slot] = className;
+            rateCount++;
+
+            if (paused) {
+                pausedCount++;
+            } else if (matches(seq)) {
+                shown.push(seq);
+            }
+            scheduleRender();
+        }
+
+        function rebuildShown() {
+            shown = [];
+            shownStart = 0;
+            for (var seq = oldestSeq(); seq < total; seq++) {
+                if (matches(seq)) shown.push(seq);
+            }
+        }
+
+        // Drop entries the ring has overwritten, compacting once the dead prefix gets large
+        function trimShown() {
+            var oldest = oldestSeq();
+            while (shownStart < shown.length && shown[shownStart] < oldest) shownStart++;
+            if (shownStart > 1000 && shownStart * 2 > shown.length) {
+                shown = shown.slice(shownStart);
+                shownStart = 0;
+            }
+        }
+
+        function scheduleRender() {
+            if (renderPending) return;
+            renderPending = true;
+            requestAnimationFrame(render);
+        }
+
+        function formatTime(ms) {
+            var date = new Date(ms);
+            var millis = date.getMilliseconds();
+            return date.toLocaleTimeString() + `.` + (millis < 100 ? (millis < 10 ? `00` : `0`) : ``) + millis;
+        }
+
+        // Draws only the rows in view, reusing the same few divs
+        function render() {
+            renderPending = false;
+            trimShown();
+            var count = shown.length - shownStart;
+            spacer.style.height = (count * ROW_HEIGHT) + `px`;
+
+            if (autoscroll.checked && !paused) serialDiv.scrollTop = serialDiv.scrollHeight;
+
+            var first = Math.max(0, Math.floor(serialDiv.scrollTop / ROW_HEIGHT) - 2);
+            var visible = Math.ceil(serialDiv.clientHeight / ROW_HEIGHT) + 4;
+            var last = Math.min(count, first + visible);
+
+            while (rowPool.length < visible) {
+                var row = document.createElement(`div`);
+                rowsDiv.appendChild(row);
+                rowPool.push(row);
+            }
+
+            rowsDiv.style.top = (first * ROW_HEIGHT) + `px`;
+            for (var i = 0; i < rowPool.length; i++) {
+                var row = rowPool[i];
+                var index = first + i;
+                if (index >= last) {
+                    row.style.display = `none`;
+                    continue;
+                }
+                var seq = shown[shownStart + index];
+                var slot = seq % CAPACITY;
+                row.style.display = ``;
+                row.className = `row ` + ringClass[slot];
+                row.textContent = `[` + formatTime(ringTime[slot]) + `] ` + ringText[slot];
+                row.dataset.seq = seq;
+            }
+
+            statsDiv.textContent = (total - oldestSeq()) + ` of ` + CAPACITY + ` buffered, ` + count + ` shown, ` +
+                rate + ` msg/s` + (paused ? `, paused (` + pausedCount + ` new)` : ``) +
+                (total > CAPACITY ? `, ` + (total - CAPACITY) + ` older dropped` : ``);
+        }
+
+        setInterval(function() {
+            rate = rateCount;
+            rateCount = 0;
+            scheduleRender();
+        }, 1000);
+
+        serialDiv.addEventListener(`scroll`, function() {
+            // Scrolling up stops auto-scroll, scrolling back to the bottom starts it again
+            if (!paused) {
+                autoscroll.checked = serialDiv.scrollTop + serialDiv.clientHeight >= serialDiv.scrollHeight - ROW_HEIGHT;
+            }
+            scheduleRender();
+        });
+        window.addEventListener(`resize`, scheduleRender);
+
+        rowsDiv.addEventListener(`click`, function(event) {
+            var row = event.target.closest(`.row`);
+            if (!row) return;
+            var seq = parseInt(row.dataset.seq, 10);
+            if (seq < oldestSeq()) return;
+            var slot = seq % CAPACITY;
+            var text = ringText[slot];
+            if (text.charAt(0) === `{`) {
+                try { text = JSON.stringify(JSON.parse(text), null, 2); } catch (e) {}
+            }
+            detailDiv.textContent = `[` + formatTime(ringTime[slot]) + `] ` + text;
+        });
+
+        function setFilter() {
+            filterText = document.getElementById(`filter`).value.toLowerCase();
+            filterKind = document.getElementById(`kind`).value;
+            rebuildShown();
+            scheduleRender();
+        }
+
+        function togglePause() {
+            paused = !paused;
+            var button = document.getElementById(`pause`);
+            button.textContent = paused ? `Resume` : `Pause`;
+            button.classList.toggle(`active`, paused);
+            if (!paused) {
+                pausedCount = 0;
+                rebuildShown();
+            }
+            scheduleRender();
+        }
+
+        // Everything still in the buffer, whatever the filter
+        function exportHistory() {
+            var lines = [];
+            for (var seq = oldestSeq(); seq < total; seq++) {
+                var slot = seq % CAPACITY;
+                lines.push(new Date(ringTime[slot]).toISOString() + ` ` + kindOf(ringClass[slot]) + ` ` + ringText[slot]);
+            }
+            var blob = new Blob([lines.join(`\n`) + `\n`], {type: `text/plain`});
+            var link = document.createElement(`a`);
+            link.href = URL.createObjectURL(blob);
+            link.download = `scoreboard-debug-` + new Date().toISOString().replace(/[:.]/g, `-`) + `.log`;
+            document.body.appendChild(link);
+            link.click();
+            document.body.removeChild(link);
+            setTimeout(function() { URL.revokeObjectURL(link.href); }, 1000);
+        }
         
         function connectWebSocket() {
             if (isConnecting) return;
@@ -290,7 +867,7 @@ const char DEBUG_HTML[] PROGMEM = R"(
             isConnecting = true;
             appendMessage(`Connecting to WebSocket...`, `info`);
             
-            ws = new WebSocket(wsUrl);
+            ws = new (window.SharedSocket || WebSocket)(wsUrl);
             
             ws.onopen = function() {
                 isConnecting = false;
@@ -312,13 +889,10 @@ const char DEBUG_HTML[] PROGMEM = R"(
             };
             
             ws.onmessage = function(event) {
-                console.log(`Message received:`, event);
-                
                 if (event.data instanceof Blob) {
                     var reader = new FileReader();
                     reader.onload = function() {
                         var data = new Uint8Array(reader.result);
-                        console.log(`Binary data:`, Array.from(data));
                         
                         var minutes = data[0];
                         var seconds = data[1];
@@ -338,7 +912,10 @@ const char DEBUG_HTML[] PROGMEM = R"(
                     };
                     reader.readAsArrayBuffer(event.data);
                 } else {
-                    appendMessage(event.data, `white`);
+                    var receivedAt = performance.now();
+                    var text = event.data;
+                    appendMessage(text, text.indexOf(`"type":"debug"`) >= 0 ? `debug` : `state`);
+                    echoLatency(text, receivedAt);
                 }
             };
             
@@ -379,20 +956,14 @@ const char DEBUG_HTML[] PROGMEM = R"(
             else return 30000;                            // 30 seconds
         }
         
-        function appendMessage(message, className) {
-            var timestamp = new Date().toLocaleTimeString();
-            var div = document.createElement(`div`);
-            div.className = className;
-            div.textContent = `[` + timestamp + `] ` + message;
-            serialDiv.appendChild(div);
-            
-            if (autoscroll.checked) {
-                serialDiv.scrollTop = serialDiv.scrollHeight;
-            }
-        }
-        
         function clearData() {
-            serialDiv.innerHTML = ``;
+            total = 0;
+            shown = [];
+            shownStart = 0;
+            pausedCount = 0;
+            ringText = new Array(CAPACITY);
+            detailDiv.textContent = `Click a line to see all of it`;
+            scheduleRender();
         }
         
         // Initialize connection
@@ -515,6 +1086,18 @@ const char SETTINGS_HTML[] PROGMEM = R"(
             font-size: 0.9em;
             margin: 3px 0 15px 0;
         }
+        input[type="number"] {
+            background: #333;
+            color: #fff;
+            padding: 5px;
+            border: 1px solid #555;
+            width: 120px;
+        }
+        .baud-rates {
+            display: flex;
+            flex-wrap: wrap;
+            gap: 5px 20px;
+        }
     </style>
 </head>
 <body>
@@ -534,9 +1117,35 @@ const char SETTINGS_HTML[] PROGMEM = R"(
             <p class="setting-description">When enabled, logs detailed debug information</p>
         </div>
 
+        <div class="form-group">
+            <label class="toggle-label">
+                <input type="checkbox" id="udpMulticast" name="udpMulticast">
+                <span class="toggle-text">UDP Multicast</span>
+            </label>
+            <p class="setting-description">Publishes every state update once to 239.255.42.42:4242 for secondary displays on the LAN</p>
+        </div>
+
+        <div class="form-group">
+            <label for="uart2Role">Second Console Input</label>
+            <select id="uart2Role" name="uart2Role">
+                <option value="0">Off</option>
+                <option value="2">Shot clock</option>
+                <option value="3">Backup game clock</option>
+            </select>
+            <p class="setting-description">Console wired to GPIO 18 (RX) / 17 (TX). A shot clock is shown next to the game clock, a backup takes over while the main console is silent. Input health is at /sources</p>
+        </div>
+
         <button type="submit">Save Settings</button>
         <button type="button" id="reconnect" onclick='manualReconnect()'>Reconnect</button>
     </form>
+
+    <h2>Tuning</h2>
+    <p class="setting-description">Timings for the console and the site. Changes apply straight away and are kept across restarts.</p>
+    <form id="tuningForm">
+        <div id="parameters"></div>
+        <button type="submit">Apply Tuning</button>
+        <button type="button" onclick='resetParameters()'>Restore Defaults</button>
+    </form>
     
     <div class='danger-zone'>
         <h3>Danger Zone</h3>
@@ -549,8 +1158,9 @@ const char SETTINGS_HTML[] PROGMEM = R"(
     </div>
     
     <div id="status"></div>
+    <script src="/ws-shared.js"></script>
         <script>
-        var wsUrl = `ws://` + location.hostname + `/ws`;
+        var wsUrl = `ws://` + location.host + `/ws`;
         var statusDiv = document.getElementById(`status`);
         var ws;
         var reconnectAttempts = 0;
@@ -563,7 +1173,7 @@ const char SETTINGS_HTML[] PROGMEM = R"(
             isConnecting = true;
             updateStatus(`Connecting...`, `info`);
             
-            ws = new WebSocket(wsUrl);
+            ws = new (window.SharedSocket || WebSocket)(wsUrl);
             
             ws.onopen = function() {
                 isConnecting = false;
@@ -595,6 +1205,15 @@ const char SETTINGS_HTML[] PROGMEM = R"(
                         if (data.settings.hasOwnProperty('debugMode')) {
                             document.getElementById('debugMode').checked = data.settings.debugMode;
                         }
+                        if (data.settings.hasOwnProperty('udpMulticast')) {
+                            document.getElementById('udpMulticast').checked = data.settings.udpMulticast;
+                        }
+                        if (data.settings.hasOwnProperty('uart2Role')) {
+                            document.getElementById('uart2Role').value = String(data.settings.uart2Role);
+                        }
+                        if (data.parameters) {
+                            renderParameters(data.parameters);
+                        }
 
                         updateStatus(`Settings loaded`, `success`);
                     } else {
@@ -652,10 +1271,103 @@ const char SETTINGS_HTML[] PROGMEM = R"(
             statusDiv.appendChild(div);
         }
         
+        // Tuning form, built from the parameter list the bridge sends with its settings
+        var parameterList = [];
+
+        function describeParameter(param, value) {
+            if (param.type === `baudMask`) {
+                return param.rates.filter(function(rate, bit) { return (value >> bit) & 1; }).join(`, `);
+            }
+            return value + (param.type === `ms` ? ` ms` : ` bytes`);
+        }
+
+        function renderParameters(list) {
+            var container = document.getElementById(`parameters`);
+            container.innerHTML = ``;
+            parameterList = list;
+            list.forEach(function(param) {
+                var group = document.createElement(`div`);
+                group.className = `form-group`;
+                var label = document.createElement(`label`);
+                label.textContent = param.label;
+                group.appendChild(label);
+
+                if (param.type === `baudMask`) {
+                    var rates = document.createElement(`div`);
+                    rates.className = `baud-rates`;
+                    param.rates.forEach(function(rate, bit) {
+                        var option = document.createElement(`label`);
+                        option.className = `toggle-label`;
+                        var box = document.createElement(`input`);
+                        box.type = `checkbox`;
+                        box.name = param.name;
+                        box.value = bit;
+                        box.checked = ((param.value >> bit) & 1) === 1;
+                        option.appendChild(box);
+                        option.appendChild(document.createTextNode(rate));
+                        rates.appendChild(option);
+                    });
+                    group.appendChild(rates);
+                } else {
+                    var input = document.createElement(`input`);
+                    input.type = `number`;
+                    input.name = param.name;
+                    input.min = param.min;
+                    input.max = param.max;
+                    input.value = param.value;
+                    group.appendChild(input);
+                }
+
+                var description = document.createElement(`p`);
+                description.className = `setting-description`;
+                description.textContent = `Default ` + describeParameter(param, param.default) +
+                    (param.type === `baudMask` ? `` : `, ` + param.min + ` to ` + param.max);
+                group.appendChild(description);
+                container.appendChild(group);
+            });
+        }
+
+        function readParameters() {
+            var values = {};
+            var form = document.getElementById(`tuningForm`);
+            parameterList.forEach(function(param) {
+                if (param.type === `baudMask`) {
+                    var mask = 0;
+                    form.querySelectorAll(`input[name="` + param.name + `"]`).forEach(function(box) {
+                        if (box.checked) mask |= 1 << parseInt(box.value, 10);
+                    });
+                    values[param.name] = mask;
+                } else {
+                    var value = parseInt(form.querySelector(`input[name="` + param.name + `"]`).value, 10);
+                    if (!isNaN(value) && value >= 0) values[param.name] = value;
+                }
+            });
+            return values;
+        }
+
+        document.getElementById(`tuningForm`).onsubmit = function(e) {
+            e.preventDefault();
+            var values = readParameters();
+            var baudRates = parameterList.filter(function(param) { return param.type === `baudMask`; })[0];
+            if (baudRates && values[baudRates.name] === 0) {
+                updateStatus(`Select at least one baud rate`, `error`);
+                return;
+            }
+            ws.send(JSON.stringify({parameters: values}));
+        };
+
+        function resetParameters() {
+            if (!confirm(`Restore every tuning value to its default?`)) return;
+            ws.send(JSON.stringify({command: `resetParameters`}));
+            ws.send(JSON.stringify({command: `getSettings`}));
+        }
+
         document.getElementById(`settingsForm`).onsubmit = function(e) {
             e.preventDefault();
             var data = {
-                debugMode: document.getElementById(`debugMode`).checked
+                debugMode: document.getElementById(`debugMode`).checked,
+                udpMulticast: document.getElementById(`udpMulticast`).checked,
+                uart2Role: parseInt(document.getElementById(`uart2Role`).value, 10)
             };
             ws.send(JSON.stringify(data));
         };
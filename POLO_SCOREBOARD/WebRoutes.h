@@ -6,6 +6,30 @@
 
 extern AsyncWebServer server;
 
+// Defined in Bench.h
+void requestBenchRun();
+String getBenchResults();
+
+// Defined in SerialHandler.h
+String getSourcesReport();
+
+// Defined in LatencyTracker.h
+String getLatencyReport(bool reset);
+
+// Defined in EventStream.h
+void setupEventStream();
+void cleanupEventStream();
+
+// Defined in StallMonitor.h
+String getHealthReport();
+
+// Defined in StateSnapshot.h
+void handleStateRequest(AsyncWebServerRequest *request);
+
+// Defined in Profiler.h
+String getProfileReport();
+void handleProfileStacksRequest(AsyncWebServerRequest *request);
+
 void setupWebRoutes() {
     // Handle root URL - Scoreboard display
     server.on("/", HTTP_GET, [](AsyncWebServerRequest *request) {
@@ -22,6 +46,57 @@ void setupWebRoutes() {
         request->send_P(200, "text/html", SETTINGS_HTML);
     });
     
+    // Shared /ws connection script, used by the pages above and as their SharedWorker
+    server.on("/ws-shared.js", HTTP_GET, [](AsyncWebServerRequest *request) {
+        request->send_P(200, "application/javascript", WS_SHARED_JS);
+    });
+    
+    // Microbenchmarks: /bench?run=1 starts a run on the loop task, /bench returns the last results
+    server.on("/bench", HTTP_GET, [](AsyncWebServerRequest *request) {
+        if (request->hasParam("run")) {
+            requestBenchRun();
+            request->send(202, "application/json", "{\"status\":\"started\"}");
+            return;
+        }
+        String results = getBenchResults();
+        if (results.length() == 0) {
+            request->send(404, "application/json", "{\"status\":\"no results, request /bench?run=1\"}");
+            return;
+        }
+        request->send(200, "application/json", results);
+    });
+    
+    // Health of each console input
+    server.on("/sources", HTTP_GET, [](AsyncWebServerRequest *request) {
+        request->send(200, "application/json", getSourcesReport());
+    });
+    
+    // Latency histograms per stage and per client, /latency?reset clears them after reading
+    server.on("/latency", HTTP_GET, [](AsyncWebServerRequest *request) {
+        request->send(200, "application/json", getLatencyReport(request->hasParam("reset")));
+    });
+    
+    // Stall detection: loop and ping timings, client queues and every recovery taken
+    server.on("/health", HTTP_GET, [](AsyncWebServerRequest *request) {
+        request->send(200, "application/json", getHealthReport());
+    });
+    
+    // PC sampler: ?start[&hz=100] clears and starts it, ?stop stops it, plain returns folded stacks.
+    // Registered before /profile, which would otherwise match it as a prefix.
+    server.on("/profile/stacks", HTTP_GET, [](AsyncWebServerRequest *request) {
+        handleProfileStacksRequest(request);
+    });
+    
+    // CPU per task and core since the last request, stack high-water marks, sampler status
+    server.on("/profile", HTTP_GET, [](AsyncWebServerRequest *request) {
+        request->send(200, "application/json", getProfileReport());
+    });
+    
+    // Current state for HTTP pollers: ETag is the sequence number, ?wait=<s> holds a matching poll for a change
+    server.on("/api/state", HTTP_GET, [](AsyncWebServerRequest *request) {
+        handleStateRequest(request);
+    });
+    
     // Handle not found
     server.onNotFound([](AsyncWebServerRequest *request) {
         request->redirect("/");
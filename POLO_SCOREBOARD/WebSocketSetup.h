@@ -8,6 +8,8 @@
 #include "SerialHandler.h"
 #include <ArduinoJson.h>
 #include <Preferences.h>
+#include "MulticastPublisher.h"
+#include "LatencyTracker.h"
 
 extern Preferences preferences;
 
@@ -19,30 +21,80 @@ AsyncWebSocket ws("/ws");
 // Function declarations
 void setupWebSocket();
 void handleWebSocketMessage(void *arg, uint8_t *data, size_t len, uint32_t clientId);
+void handleTimeSync(const uint8_t *data, size_t len, uint32_t clientId, uint32_t receivedUs);
 void onEvent(AsyncWebSocket *server, AsyncWebSocketClient *client, AwsEventType type, void *arg, uint8_t *data, size_t len);
 
+// Defined in StallMonitor.h
+void noteClientEvent(uint32_t clientId, AwsEventType type);
+
 // Function implementations
 void onEvent(AsyncWebSocket *server, AsyncWebSocketClient *client, AwsEventType type, void *arg, uint8_t *data, size_t len) {
     switch (type) {
         case WS_EVT_CONNECT:
             Serial.printf("WebSocket client #%u connected from %s\n", client->id(), client->remoteIP().toString().c_str());
+            noteClientEvent(client->id(), type);
             break;
         case WS_EVT_DISCONNECT:
             Serial.printf("WebSocket client #%u disconnected\n", client->id());
+            latencyTracker.removeClient(client->id());
+            noteClientEvent(client->id(), type);
             break;
         case WS_EVT_DATA:
             handleWebSocketMessage(arg, data, len, client->id()); // Pass client ID as additional parameter
             break;
         case WS_EVT_PONG:
+            noteClientEvent(client->id(), type);
+            break;
         case WS_EVT_ERROR:
             break;
     }
 }
 
+// NTP-style exchange: the page sends t0 on its own clock, the bridge answers with t1 (received)
+// and t2 (replied) on its micros() clock. The page works out its offset from the bridge and the
+// round trip, and reports that round trip with its next request. All times are microseconds mod 2^32.
+void handleTimeSync(const uint8_t *data, size_t len, uint32_t clientId, uint32_t receivedUs) {
+    StaticJsonDocument<128> request;
+    if (deserializeJson(request, (const char*)data, len)) return;
+
+    uint32_t rttUs = request["rtt"] | 0;
+    if (rttUs > 0 && rttUs < 10000000) {
+        AsyncWebSocketClient *client = ws.client(clientId);
+        uint32_t remoteIp = client != nullptr ? (uint32_t)client->remoteIP() : 0;
+        latencyTracker.recordRoundTrip(clientId, remoteIp, rttUs);
+    }
+
+    char reply[112];
+    uint32_t t0 = request["t0"] | 0;
+    uint32_t playoutMs = latencyTracker.getPlayoutMs();
+    snprintf(reply, sizeof(reply), "{\"type\":\"timeSync\",\"t0\":%lu,\"t1\":%lu,\"t2\":%lu,\"playout\":%lu}",
+             (unsigned long)t0, (unsigned long)receivedUs, (unsigned long)micros(), (unsigned long)playoutMs);
+    ws.text(clientId, reply);
+}
+
 void handleWebSocketMessage(void *arg, uint8_t *data, size_t len, uint32_t clientId) {
+    uint32_t receivedUs = micros();
     AwsFrameInfo *info = (AwsFrameInfo*)arg;
     if (info->final && info->index == 0 && info->len == len && info->opcode == WS_TEXT) {
         data[len] = 0;
+
+        // Clock sync from the scoreboard page - answered straight away so the bridge adds
+        // as little as possible to the round trip the page measures
+        if (strstr((char*)data, "\"type\":\"timeSync\"") != nullptr) {
+            handleTimeSync(data, len, clientId, receivedUs);
+            return;
+        }
+
+        // Latency echo from a page opened with ?latency - handled first, before any logging
+        if (strstr((char*)data, "\"type\":\"latencyEcho\"") != nullptr) {
+            StaticJsonDocument<192> echo;
+            if (!deserializeJson(echo, (const char*)data, len)) {
+                latencyTracker.recordEcho(clientId, echo["seq"].as<uint32_t>(), echo["ts"].as<uint32_t>(),
+                                          echo["recv"].as<double>(), echo["paint"].as<double>());
+            }
+            return;
+        }
+
         String message = (char*)data;
         Serial.printf("Received WebSocket message: %s\n", message.c_str());
         
@@ -57,10 +109,13 @@ void handleWebSocketMessage(void *arg, uint8_t *data, size_t len, uint32_t clien
         // Check for getSettings command
         if (message.indexOf("\"command\":\"getSettings\"") > 0) {
             // Create JSON with current settings
-            DynamicJsonDocument doc(256);
+            DynamicJsonDocument doc(3072);
             JsonObject settings = doc.createNestedObject("settings");
             settings["debugMode"] = serialHandler.getDebug();
             settings["baudRate"] = Serial.baudRate();
+            settings["udpMulticast"] = multicastPublisher.isEnabled();
+            settings["uart2Role"] = (int)serialHandler.getSecondSourceRole();
+            parameters.toJson(doc.createNestedArray("parameters"));
             
             String jsonString;
             serializeJson(doc, jsonString);
@@ -68,18 +123,79 @@ void handleWebSocketMessage(void *arg, uint8_t *data, size_t len, uint32_t clien
             return;
         }
         
-        // Check for debugMode setting
-        if (message.indexOf("\"debugMode\":") > 0) {
-            bool debugEnabled = message.indexOf("\"debugMode\":true") > 0;
-            serialHandler.setDebug(debugEnabled);
-            
-            // Save to preferences
-            preferences.putBool("debugMode", debugEnabled);
-            
-            String response = "{\"status\":\"success\",\"message\":\"Debug mode ";
-            response += debugEnabled ? "enabled" : "disabled";
+        // Tuning from the settings page, applied live and saved
+        if (message.indexOf("\"parameters\":") > 0) {
+            DynamicJsonDocument doc(1024);
+            if (deserializeJson(doc, message)) {
+                ws.text(clientId, "{\"status\":\"error\",\"message\":\"Invalid parameters\"}");
+                return;
+            }
+            String response = "{\"status\":\"success\",\"message\":\"";
+            int changed = 0;
+            for (JsonPair entry : doc["parameters"].as<JsonObject>()) {
+                int id = Parameters::find(entry.key().c_str());
+                if (id < 0 || !entry.value().is<uint32_t>()) continue;
+                uint32_t previous = parameters.get((ParameterId)id);
+                uint32_t stored = parameters.set((ParameterId)id, entry.value().as<uint32_t>());
+                if (stored == previous) continue;
+                if (changed++ > 0) response += ", ";
+                response += entry.key().c_str();
+                response += " = ";
+                response += stored;
+            }
+            if (changed == 0) response += "Parameters unchanged";
+            response += "\"}";
+            ws.text(clientId, response);
+            return;
+        }
+
+        if (message.indexOf("\"command\":\"resetParameters\"") > 0) {
+            parameters.resetAll();
+            ws.text(clientId, "{\"status\":\"success\",\"message\":\"Parameters back to defaults\"}");
+            return;
+        }
+
+        // Check for settings (the settings form sends all of them at once)
+        bool hasDebugMode = message.indexOf("\"debugMode\":") > 0;
+        bool hasMulticast = message.indexOf("\"udpMulticast\":") > 0;
+        int roleIndex = message.indexOf("\"uart2Role\":");
+        bool hasUart2Role = roleIndex > 0;
+        if (hasDebugMode || hasMulticast || hasUart2Role) {
+            String response = "{\"status\":\"success\",\"message\":\"";
+
+            if (hasDebugMode) {
+                bool debugEnabled = message.indexOf("\"debugMode\":true") > 0;
+                serialHandler.setDebug(debugEnabled);
+                
+                // Save to preferences
+                preferences.putBool("debugMode", debugEnabled);
+                
+                response += "Debug mode ";
+                response += debugEnabled ? "enabled" : "disabled";
+            }
+
+            if (hasMulticast) {
+                bool multicastEnabled = message.indexOf("\"udpMulticast\":true") > 0;
+                multicastPublisher.setEnabled(multicastEnabled);
+                preferences.putBool("udpMulticast", multicastEnabled);
+
+                if (hasDebugMode) response += ", ";
+                response += "UDP multicast ";
+                response += multicastEnabled ? "enabled" : "disabled";
+            }
+
+            if (hasUart2Role) {
+                int role = message.substring(roleIndex + 12).toInt();
+                if (role < SOURCE_DISABLED || role > SOURCE_BACKUP || role == SOURCE_MAIN) role = SOURCE_DISABLED;
+                serialHandler.setSecondSourceRole((SourceRole)role);
+                preferences.putUChar("uart2Role", (uint8_t)role);
+
+                if (hasDebugMode || hasMulticast) response += ", ";
+                response += "second console ";
+                response += SOURCE_ROLE_NAMES[role];
+            }
+
             response += "\"}";
-            
             ws.text(clientId, response); // Use the clientId variable
             return;
         }
@@ -103,6 +219,7 @@ void setupWebSocket() {
     // Attach WebSocket handler
     ws.onEvent(onEvent);
     server.addHandler(&ws);
+    setupEventStream(); // Game events on /events
     MDNS.addService("http", "tcp", 80);
     // Setup web routes
     setupWebRoutes();
@@ -113,6 +230,7 @@ void setupWebSocket() {
 // Call this in your loop() function to clean up disconnected clients
 void cleanupWebSocket() {
     ws.cleanupClients();
+    cleanupEventStream();
 }
 
 #endif // WEBSOCKET_SETUP_H
\ No newline at end of file
@@ -7,28 +7,42 @@
 #include "DisplaySetup.h"
 #include "FS.h"
 #include <FFat.h> //like yo'mama
+#include <Preferences.h>
 
 // External declarations 
 extern WiFiManager wm;
 extern void setupWebSocket(); 
 extern TFT_eSPI tft;  // Add this to access the TFT directly in the callback
 
+extern Preferences preferences;
+
 // Function declarations
-bool setupWiFi();
+void startWiFi();
+bool updateWiFi();
 bool initFS();
 extern void displayMessage(String message);
 extern bool inConfigPortalMode;
 
+// Boot-time connection state
+const unsigned long WIFI_HINT_TIMEOUT = 4000;      // Cached channel/BSSID gets this long before a full scan
+const unsigned long WIFI_CONNECT_TIMEOUT = 20000;  // Then the config portal opens
+volatile bool wifiGotIP = false;   // Set from the WiFi event task
+bool wifiUsedHints = false;
+unsigned long wifiConnectStart = 0; // 0 once the first connection is made
+unsigned long wifiLostSince = 0;    // When the link dropped after the first connection
+unsigned long wifiLastReconnect = 0;
+const unsigned long WIFI_RECONNECT_INTERVAL = 10000; // Nudge the driver if auto-reconnect stalls
+String wifiSSID;
+String wifiPass;
+
 // Function to generate a unique AP name based on ESP32 chip ID
 String getUniqueAPName() {
     uint32_t chipId = (uint32_t)(ESP.getEfuseMac() >> 32); // Get upper 32 bits of MAC
     return "FC-Scoreboard-" + String(chipId & 0xFFFF, HEX); // Use last 16 bits (4 hex chars)
 }
 
-void configModeCallback(WiFiManager *myWiFiManager) {
-    Serial.println("Entered config mode");
-    inConfigPortalMode = true;
-    
+// Portal instructions on the TFT, also redrawn by the /bench runner
+void displayConfigPortal() {
     // Get the dynamic AP name
     String apName = getUniqueAPName();
 
@@ -67,6 +81,12 @@ void configModeCallback(WiFiManager *myWiFiManager) {
     tft.drawString("Then visit 192.168.4.1 in your browser", tft.width()/2, tft.height() - 10);
 }
 
+void configModeCallback(WiFiManager *myWiFiManager) {
+    Serial.println("Entered config mode");
+    inConfigPortalMode = true;
+    displayConfigPortal();
+}
+
 // Function implementations - keeping all existing functionality
 bool initFS() {
     if (!FFat.begin(true)) {
@@ -77,38 +97,111 @@ bool initFS() {
     return true;
 }
 
-bool setupWiFi() {
-    // Initialize filesystem first
-    if (!initFS()) {
-        Serial.println("Warning: Filesystem initialization failed");
-    }
-    
-    // Set the callback BEFORE autoConnect
-    wm.setAPCallback(configModeCallback);
+void onWiFiGotIP(arduino_event_id_t event) {
+    wifiGotIP = true;
+}
 
-    // Get the dynamic AP name
+void startConfigPortal() {
+    // Non-blocking so UART ingest keeps running while the portal is open
+    wm.setConfigPortalBlocking(false);
     String apName = getUniqueAPName();
-    
-    // Try to connect using saved credentials
-    if (!wm.autoConnect(apName.c_str(), "12345678")) {
-        inConfigPortalMode = false; // Reset flag when failed
-        return false; 
+    wm.startConfigPortal(apName.c_str(), "12345678");
+}
+
+// Remember where the AP was so the next boot can skip the scan.
+// Runs on every reconnect, so only writes flash when the AP actually moved.
+void cacheWiFiHints() {
+    uint8_t* bssid = WiFi.BSSID();
+    if (bssid == nullptr) return;
+
+    String ssid = WiFi.SSID();
+    uint8_t channel = (uint8_t)WiFi.channel();
+    uint8_t savedBssid[6];
+    bool sameBssid = preferences.getBytes("wifiBssid", savedBssid, 6) == 6 && memcmp(savedBssid, bssid, 6) == 0;
+    if (sameBssid && preferences.getUChar("wifiChannel", 0) == channel && preferences.getString("wifiSsid", "") == ssid) return;
+
+    preferences.putString("wifiSsid", ssid);
+    preferences.putUChar("wifiChannel", channel);
+    preferences.putBytes("wifiBssid", bssid, 6);
+}
+
+// Starts connecting with the saved credentials and returns immediately
+void startWiFi() {
+    WiFi.mode(WIFI_STA);
+    WiFi.setAutoReconnect(true);
+    WiFi.onEvent(onWiFiGotIP, ARDUINO_EVENT_WIFI_STA_GOT_IP);
+    wm.setAPCallback(configModeCallback);
+
+    if (!wm.getWiFiIsSaved()) {
+        startConfigPortal();
+        return;
     }
 
-    // Reset flag when connected
-    inConfigPortalMode = false;
-    
-    // Rest of your existing code
-    if (WiFi.status() == WL_CONNECTED) {
+    wifiSSID = wm.getWiFiSSID();
+    wifiPass = wm.getWiFiPass();
+    wifiConnectStart = millis();
+
+    // Cached channel and BSSID skip the full scan, only valid for the same network
+    uint8_t bssid[6];
+    uint8_t channel = 0;
+    if (preferences.getString("wifiSsid") == wifiSSID &&
+        preferences.getBytes("wifiBssid", bssid, sizeof(bssid)) == sizeof(bssid)) {
+        channel = preferences.getUChar("wifiChannel", 0);
+    }
+
+    if (channel > 0) {
+        wifiUsedHints = true;
+        WiFi.begin(wifiSSID.c_str(), wifiPass.c_str(), channel, bssid);
+    } else {
+        WiFi.begin(wifiSSID.c_str(), wifiPass.c_str());
+    }
+}
+
+// Call every loop pass. Returns true once each time an IP address is assigned.
+bool updateWiFi() {
+    if (inConfigPortalMode) {
+        wm.process();
+    }
+
+    if (wifiGotIP) {
+        wifiGotIP = false;
+        inConfigPortalMode = false; // Portal is done once we're connected
+        wifiConnectStart = 0;
+        wifiLostSince = 0;
         Serial.println("WiFi Connected!");
-        displayMessage("WiFi Connected!");
+        cacheWiFiHints();
         return true;
     }
-    
-    // Connection failed
-    displayMessage("Wi-Fi connection failed.\nRebooting...");
-    delay(3000);
-    ESP.restart();
+
+    if (inConfigPortalMode || WiFi.status() == WL_CONNECTED) {
+        return false;
+    }
+
+    // After the first connection, outages only retry - the server and portal are left alone
+    if (wifiConnectStart == 0) {
+        unsigned long now = millis();
+        if (wifiLostSince == 0) {
+            wifiLostSince = now;
+            wifiLastReconnect = now;
+        } else if (now - wifiLastReconnect > WIFI_RECONNECT_INTERVAL) {
+            wifiLastReconnect = now;
+            WiFi.reconnect();
+        }
+        return false;
+    }
+
+    // Only the first connection falls back to a scan and then the portal
+
+    unsigned long elapsed = millis() - wifiConnectStart;
+    if (wifiUsedHints && elapsed > WIFI_HINT_TIMEOUT) {
+        // AP may have moved channel - try again with a full scan
+        wifiUsedHints = false;
+        WiFi.disconnect();
+        WiFi.begin(wifiSSID.c_str(), wifiPass.c_str());
+    } else if (elapsed > WIFI_CONNECT_TIMEOUT) {
+        wifiConnectStart = 0;
+        startConfigPortal();
+    }
     return false;
 }
 
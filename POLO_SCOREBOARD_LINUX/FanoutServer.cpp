@@ -0,0 +1,421 @@
+#include "FanoutServer.h"
+
+#include <errno.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <deque>
+#include <thread>
+#include <unordered_map>
+
+#include "WebProtocol.h"
+
+static const size_t MAX_REQUEST_HEAD = 8192;
+
+struct FanoutConnection {
+    int fd = -1;
+    bool webSocket = false;
+    bool closeAfterWrite = false;
+    bool wantWrite = false;
+    std::string request;
+    std::deque<SharedFrame> out;
+    size_t outOffset = 0;   // Bytes of out.front() already written
+    WebSocketFrameParser parser;
+};
+
+class FanoutServer::Worker {
+public:
+    FanoutServer& server;
+    int epfd = -1;
+    int listenFd = -1;
+    int wakeFd = -1;
+    std::thread thread;
+    std::atomic<bool> running{false};
+
+    std::mutex inboxMutex;
+    std::vector<SharedFrame> inbox;
+    std::unordered_map<int, std::unique_ptr<FanoutConnection>> connections;
+
+    explicit Worker(FanoutServer& owner) : server(owner) {}
+
+    ~Worker() {
+        for (auto& entry : connections) ::close(entry.first);
+        if (listenFd >= 0) ::close(listenFd);
+        if (wakeFd >= 0) ::close(wakeFd);
+        if (epfd >= 0) ::close(epfd);
+    }
+
+    bool open(std::string& error) {
+        listenFd = socket(AF_INET6, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (listenFd < 0) {
+            error = std::string("socket: ") + strerror(errno);
+            return false;
+        }
+        int on = 1, off = 0;
+        setsockopt(listenFd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+        setsockopt(listenFd, SOL_SOCKET, SO_REUSEPORT, &on, sizeof(on));
+        setsockopt(listenFd, IPPROTO_IPV6, IPV6_V6ONLY, &off, sizeof(off));
+
+        sockaddr_in6 addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sin6_family = AF_INET6;
+        addr.sin6_port = htons(server.options.port);
+        addr.sin6_addr = in6addr_any;
+        if (bind(listenFd, (sockaddr*)&addr, sizeof(addr)) < 0 || listen(listenFd, 1024) < 0) {
+            error = std::string("bind/listen: ") + strerror(errno);
+            return false;
+        }
+
+        epfd = epoll_create1(EPOLL_CLOEXEC);
+        wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (epfd < 0 || wakeFd < 0) {
+            error = std::string("epoll/eventfd: ") + strerror(errno);
+            return false;
+        }
+
+        epoll_event ev;
+        memset(&ev, 0, sizeof(ev));
+        ev.events = EPOLLIN;
+        ev.data.fd = listenFd;
+        epoll_ctl(epfd, EPOLL_CTL_ADD, listenFd, &ev);
+        ev.data.fd = wakeFd;
+        epoll_ctl(epfd, EPOLL_CTL_ADD, wakeFd, &ev);
+        return true;
+    }
+
+    void start() {
+        running = true;
+        thread = std::thread(&Worker::run, this);
+    }
+
+    void stop() {
+        running = false;
+        wake();
+        if (thread.joinable()) thread.join();
+    }
+
+    void wake() {
+        uint64_t one = 1;
+        ssize_t ignored = write(wakeFd, &one, sizeof(one));
+        (void)ignored;
+    }
+
+    void post(const SharedFrame& frame) {
+        {
+            std::lock_guard<std::mutex> lock(inboxMutex);
+            inbox.push_back(frame);
+        }
+        wake();
+    }
+
+    void run() {
+        epoll_event events[256];
+        while (running) {
+            int count = epoll_wait(epfd, events, 256, 1000);
+            if (count < 0 && errno != EINTR) break;
+
+            for (int i = 0; i < count; i++) {
+                int fd = events[i].data.fd;
+                if (fd == listenFd) {
+                    acceptClients();
+                } else if (fd == wakeFd) {
+                    uint64_t value;
+                    ssize_t ignored = read(wakeFd, &value, sizeof(value));
+                    (void)ignored;
+                    deliverInbox();
+                } else {
+                    auto it = connections.find(fd);
+                    if (it == connections.end()) continue;
+                    FanoutConnection* conn = it->second.get();
+
+                    bool alive = true;
+                    if (events[i].events & (EPOLLERR | EPOLLHUP)) alive = false;
+                    if (alive && (events[i].events & EPOLLIN)) alive = handleReadable(conn);
+                    if (alive && (events[i].events & EPOLLOUT)) alive = flush(conn);
+                    if (!alive) closeConnection(fd);
+                }
+            }
+        }
+    }
+
+    void acceptClients() {
+        while (true) {
+            int fd = accept4(listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+            if (fd < 0) return; // EAGAIN or a transient error, epoll will report again
+
+            if (server.clientCount.load() >= server.options.maxClients) {
+                server.rejected++;
+                ::close(fd);
+                continue;
+            }
+            server.clientCount++;
+
+            int on = 1;
+            setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+
+            std::unique_ptr<FanoutConnection> conn(new FanoutConnection());
+            conn->fd = fd;
+            epoll_event ev;
+            memset(&ev, 0, sizeof(ev));
+            ev.events = EPOLLIN | EPOLLRDHUP;
+            ev.data.fd = fd;
+            epoll_ctl(epfd, EPOLL_CTL_ADD, fd, &ev);
+            connections[fd] = std::move(conn);
+        }
+    }
+
+    void closeConnection(int fd) {
+        auto it = connections.find(fd);
+        if (it == connections.end()) return;
+        if (it->second->webSocket) server.webSocketClients--;
+        server.clientCount--;
+        epoll_ctl(epfd, EPOLL_CTL_DEL, fd, nullptr);
+        ::close(fd);
+        connections.erase(it);
+    }
+
+    void setWantWrite(FanoutConnection* conn, bool want) {
+        if (conn->wantWrite == want) return;
+        conn->wantWrite = want;
+        epoll_event ev;
+        memset(&ev, 0, sizeof(ev));
+        ev.events = EPOLLIN | EPOLLRDHUP | (want ? (uint32_t)EPOLLOUT : 0u);
+        ev.data.fd = conn->fd;
+        epoll_ctl(epfd, EPOLL_CTL_MOD, conn->fd, &ev);
+    }
+
+    void enqueue(FanoutConnection* conn, const SharedFrame& frame) {
+        if (!frame) return;
+
+        // A client that can't keep up only needs the latest full state, not the backlog
+        if (conn->out.size() >= server.options.maxQueuedFrames) {
+            SharedFrame inFlight;
+            if (conn->outOffset > 0) inFlight = conn->out.front();
+            conn->out.clear();
+            if (inFlight) conn->out.push_back(inFlight);
+            SharedFrame latest = server.getSnapshot();
+            if (latest && latest != frame) conn->out.push_back(latest);
+            server.coalesced++;
+        }
+        conn->out.push_back(frame);
+        server.framesQueued++;
+    }
+
+    void deliverInbox() {
+        std::vector<SharedFrame> frames;
+        {
+            std::lock_guard<std::mutex> lock(inboxMutex);
+            frames.swap(inbox);
+        }
+        if (frames.empty()) return;
+
+        std::vector<int> dead;
+        for (auto& entry : connections) {
+            FanoutConnection* conn = entry.second.get();
+            if (!conn->webSocket || conn->closeAfterWrite) continue;
+            for (const SharedFrame& frame : frames) enqueue(conn, frame);
+            if (!flush(conn)) dead.push_back(entry.first);
+        }
+        for (int fd : dead) closeConnection(fd);
+    }
+
+    // Writes as much as the socket takes; false when the connection should be closed
+    bool flush(FanoutConnection* conn) {
+        while (!conn->out.empty()) {
+            const std::string& data = *conn->out.front();
+            ssize_t n = send(conn->fd, data.data() + conn->outOffset, data.size() - conn->outOffset, MSG_NOSIGNAL);
+            if (n < 0) {
+                if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                    setWantWrite(conn, true);
+                    return true;
+                }
+                if (errno == EINTR) continue;
+                return false;
+            }
+            server.bytesSent += (size_t)n;
+            conn->outOffset += (size_t)n;
+            if (conn->outOffset == data.size()) {
+                conn->out.pop_front();
+                conn->outOffset = 0;
+            }
+        }
+        setWantWrite(conn, false);
+        return !conn->closeAfterWrite;
+    }
+
+    bool handleReadable(FanoutConnection* conn) {
+        char buf[4096];
+        while (true) {
+            ssize_t n = recv(conn->fd, buf, sizeof(buf), 0);
+            if (n == 0) return false;
+            if (n < 0) {
+                if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+                if (errno == EINTR) continue;
+                return false;
+            }
+
+            if (conn->webSocket) {
+                conn->parser.feed(buf, (size_t)n);
+            } else {
+                conn->request.append(buf, (size_t)n);
+                if (conn->request.size() > MAX_REQUEST_HEAD) return false;
+            }
+        }
+
+        if (!conn->webSocket) {
+            size_t headEnd = conn->request.find("\r\n\r\n");
+            if (headEnd == std::string::npos) return true;
+            if (!handleHttpRequest(conn, conn->request.substr(0, headEnd + 2))) return false;
+            // Frames pipelined right behind the upgrade request
+            if (conn->webSocket && conn->request.size() > headEnd + 4) {
+                conn->parser.feed(conn->request.data() + headEnd + 4, conn->request.size() - headEnd - 4);
+            }
+            conn->request.clear();
+        }
+
+        if (conn->webSocket && !handleWebSocketMessages(conn)) return false;
+        return flush(conn);
+    }
+
+    bool handleHttpRequest(FanoutConnection* conn, const std::string& head) {
+        HttpRequest request;
+        if (!parseHttpRequest(head, request)) return false;
+        server.httpRequests++;
+
+        if (request.path == server.options.webSocketPath && request.isWebSocketUpgrade()) {
+            std::string response =
+                "HTTP/1.1 101 Switching Protocols\r\n"
+                "Upgrade: websocket\r\n"
+                "Connection: Upgrade\r\n"
+                "Sec-WebSocket-Accept: " + webSocketAcceptKey(request.header("sec-websocket-key")) + "\r\n"
+                "\r\n";
+            conn->out.push_back(std::make_shared<const std::string>(response));
+            conn->webSocket = true;
+            server.webSocketClients++;
+
+            // Snapshot on join: the new client renders immediately
+            enqueue(conn, server.getSnapshot());
+            return true;
+        }
+
+        std::map<std::string, SharedFrame>::const_iterator page = server.pages.find(request.path);
+        conn->out.push_back(page != server.pages.end() ? page->second : server.redirectResponse);
+        conn->closeAfterWrite = true;
+        return true;
+    }
+
+    bool handleWebSocketMessages(FanoutConnection* conn) {
+        WebSocketMessage message;
+        while (true) {
+            WebSocketFrameParser::Result result = conn->parser.next(message);
+            if (result == WebSocketFrameParser::NEED_MORE) return true;
+            if (result == WebSocketFrameParser::PROTOCOL_ERROR) return false;
+
+            switch (message.opcode) {
+                case WS_OP_TEXT:
+                    if (server.messageHandler) {
+                        enqueue(conn, server.messageHandler(message.payload));
+                    }
+                    break;
+                case WS_OP_PING:
+                    conn->out.push_back(std::make_shared<const std::string>(
+                        encodeWebSocketFrame(WS_OP_PONG, message.payload.data(), message.payload.size(), false)));
+                    break;
+                case WS_OP_CLOSE:
+                    conn->out.push_back(std::make_shared<const std::string>(
+                        encodeWebSocketFrame(WS_OP_CLOSE, message.payload.data(),
+                                             message.payload.size() >= 2 ? 2 : 0, false)));
+                    conn->closeAfterWrite = true;
+                    return true;
+                default:
+                    break;
+            }
+        }
+    }
+};
+
+FanoutServer::FanoutServer(const FanoutOptions& opts) : options(opts) {
+    if (options.threads <= 0) {
+        options.threads = (int)std::thread::hardware_concurrency();
+        if (options.threads <= 0) options.threads = 1;
+    }
+    if (options.maxQueuedFrames < 2) options.maxQueuedFrames = 2;
+
+    redirectResponse = std::make_shared<const std::string>(
+        "HTTP/1.1 302 Found\r\n"
+        "Location: /\r\n"
+        "Content-Length: 0\r\n"
+        "Connection: close\r\n"
+        "\r\n");
+}
+
+FanoutServer::~FanoutServer() {
+    stop();
+}
+
+void FanoutServer::addPage(const std::string& path, const std::string& contentType, const std::string& body) {
+    std::string response =
+        "HTTP/1.1 200 OK\r\n"
+        "Content-Type: " + contentType + "\r\n"
+        "Content-Length: " + std::to_string(body.size()) + "\r\n"
+        "Cache-Control: no-cache\r\n"
+        "Connection: close\r\n"
+        "\r\n" + body;
+    pages[path] = std::make_shared<const std::string>(response);
+}
+
+void FanoutServer::setMessageHandler(MessageHandler handler) {
+    messageHandler = handler;
+}
+
+bool FanoutServer::start(std::string& error) {
+    for (int i = 0; i < options.threads; i++) {
+        std::unique_ptr<Worker> worker(new Worker(*this));
+        if (!worker->open(error)) {
+            workers.clear();
+            return false;
+        }
+        workers.push_back(std::move(worker));
+    }
+    for (auto& worker : workers) worker->start();
+    return true;
+}
+
+void FanoutServer::stop() {
+    for (auto& worker : workers) worker->stop();
+    workers.clear();
+}
+
+void FanoutServer::setSnapshot(SharedFrame frame) {
+    std::lock_guard<std::mutex> lock(snapshotMutex);
+    snapshot = frame;
+}
+
+SharedFrame FanoutServer::getSnapshot() const {
+    std::lock_guard<std::mutex> lock(snapshotMutex);
+    return snapshot;
+}
+
+void FanoutServer::broadcast(SharedFrame frame) {
+    if (!frame) return;
+    for (auto& worker : workers) worker->post(frame);
+}
+
+FanoutStats FanoutServer::getStats() const {
+    FanoutStats stats;
+    stats.httpRequests = httpRequests.load();
+    stats.webSocketClients = webSocketClients.load();
+    stats.framesQueued = framesQueued.load();
+    stats.bytesSent = bytesSent.load();
+    stats.coalesced = coalesced.load();
+    stats.rejected = rejected.load();
+    return stats;
+}
+
+SharedFrame FanoutServer::makeTextFrame(const std::string& text) {
+    return std::make_shared<const std::string>(encodeWebSocketText(text));
+}
@@ -0,0 +1,88 @@
+#ifndef FANOUT_SERVER_H
+#define FANOUT_SERVER_H
+
+#include <stdint.h>
+#include <atomic>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// A frame is serialized once and the same buffer is queued to every client
+typedef std::shared_ptr<const std::string> SharedFrame;
+
+struct FanoutOptions {
+    uint16_t port = 8080;
+    int threads = 0;                // 0 = one per core
+    size_t maxClients = 10000;
+    size_t maxQueuedFrames = 64;    // Beyond this a slow client is coalesced to the latest snapshot
+    std::string webSocketPath = "/ws";
+};
+
+struct FanoutStats {
+    size_t httpRequests = 0;
+    size_t webSocketClients = 0;
+    size_t framesQueued = 0;
+    size_t bytesSent = 0;
+    size_t coalesced = 0;
+    size_t rejected = 0;
+};
+
+// epoll based HTTP + WebSocket server. Each worker thread has its own epoll set and
+// its own SO_REUSEPORT listener, so the kernel spreads connections across cores.
+class FanoutServer {
+public:
+    // Called for every text message a downstream client sends. Return a frame to reply
+    // to that client only, or nullptr for no reply. Called from worker threads.
+    typedef std::function<SharedFrame(const std::string& text)> MessageHandler;
+
+    explicit FanoutServer(const FanoutOptions& options);
+    ~FanoutServer();
+
+    FanoutServer(const FanoutServer&) = delete;
+    FanoutServer& operator=(const FanoutServer&) = delete;
+
+    // Pages and the handler must be set before start()
+    void addPage(const std::string& path, const std::string& contentType, const std::string& body);
+    void setMessageHandler(MessageHandler handler);
+
+    bool start(std::string& error);
+    void stop();
+
+    // Sent to every client as soon as its WebSocket opens
+    void setSnapshot(SharedFrame frame);
+    SharedFrame getSnapshot() const;
+
+    // Queues the frame to every open WebSocket client on every worker
+    void broadcast(SharedFrame frame);
+
+    FanoutStats getStats() const;
+
+    static SharedFrame makeTextFrame(const std::string& text);
+
+private:
+    class Worker;
+    friend class Worker;
+
+    FanoutOptions options;
+    std::map<std::string, SharedFrame> pages;   // Complete HTTP responses
+    SharedFrame redirectResponse;
+    MessageHandler messageHandler;
+
+    mutable std::mutex snapshotMutex;
+    SharedFrame snapshot;
+
+    std::vector<std::unique_ptr<Worker>> workers;
+
+    std::atomic<size_t> clientCount{0};
+    std::atomic<size_t> httpRequests{0};
+    std::atomic<size_t> webSocketClients{0};
+    std::atomic<size_t> framesQueued{0};
+    std::atomic<size_t> bytesSent{0};
+    std::atomic<size_t> coalesced{0};
+    std::atomic<size_t> rejected{0};
+};
+
+#endif // FANOUT_SERVER_H
@@ -0,0 +1,180 @@
+#ifndef HUB_PAGE_H
+#define HUB_PAGE_H
+
+// Tournament overview served by scoreboard_hub: one card per field, fed by the hub's
+// combined /ws feed (a snapshot, then deltas and field status changes)
+const char HUB_HTML[] = R"(
+<!DOCTYPE html>
+<html>
+<head>
+    <title>Tournament Overview</title>
+    <meta name="viewport" content="width=device-width, initial-scale=1">
+    <link href="https://fonts.googleapis.com/css2?family=Orbitron:wght@400;700&display=swap" rel="stylesheet">
+    <style>
+        body {
+            font-family: Arial, sans-serif;
+            margin: 0;
+            padding: 0;
+            background: #1a1a1a;
+            color: #fff;
+        }
+        .header {
+            background: #333;
+            padding: 10px 20px;
+            font-weight: bold;
+        }
+        .fields {
+            display: grid;
+            grid-template-columns: repeat(auto-fill, minmax(320px, 1fr));
+            gap: 16px;
+            padding: 16px;
+        }
+        .field {
+            background: #222;
+            border: 1px solid #333;
+            border-radius: 6px;
+            padding: 12px;
+            text-align: center;
+        }
+        .field.offline { opacity: 0.4; }
+        .label {
+            font-size: 1.2em;
+            font-weight: bold;
+            margin-bottom: 6px;
+        }
+        .address { color: #777; font-size: 0.8em; }
+        .time {
+            font-size: 3.5em;
+            font-weight: bold;
+            font-family: 'Orbitron', monospace;
+            color: #ff0;
+            margin: 8px 0;
+        }
+        .time.stopped { color: #aa0; }
+        .shot {
+            font-family: 'Orbitron', monospace;
+            color: #8f8;
+            min-height: 1.2em;
+        }
+        .scores {
+            display: flex;
+            justify-content: space-around;
+            font-size: 3em;
+            font-weight: bold;
+            font-family: 'Orbitron', sans-serif;
+        }
+        .home { color: #0cf; }
+        .away { color: #f80; }
+        .status {
+            position: fixed;
+            bottom: 10px;
+            right: 10px;
+            color: #888;
+            font-size: 12px;
+        }
+        .disconnected { color: #f44; }
+    </style>
+</head>
+<body>
+    <div class="header">Tournament Overview</div>
+    <div class="fields" id="fields"></div>
+    <div id="status" class="status">Connecting...</div>
+
+    <script>
+        var fieldsDisplay = document.getElementById(`fields`);
+        var statusDisplay = document.getElementById(`status`);
+        var fields = {};
+        var cards = {};
+        var hubSeq = -1;
+        var ws;
+
+        function card(id) {
+            if (cards[id]) return cards[id];
+            var element = document.createElement(`div`);
+            element.className = `field`;
+            element.innerHTML = `<div class="label"></div><div class="address"></div><div class="time">--:--</div>` +
+                                `<div class="shot"></div><div class="scores"><span class="home">--</span><span class="away">--</span></div>`;
+            // Keep the cards in field order
+            var ids = Object.keys(cards).concat(id).sort();
+            var next = ids[ids.indexOf(id) + 1];
+            fieldsDisplay.insertBefore(element, next ? cards[next] : null);
+            cards[id] = element;
+            return element;
+        }
+
+        function render(id) {
+            var field = fields[id];
+            var element = card(id);
+            var state = field.state;
+            element.classList.toggle(`offline`, !field.online);
+            element.querySelector(`.label`).textContent = field.label + (field.online ? `` : ` (offline)`);
+            element.querySelector(`.address`).textContent = field.address;
+            var time = element.querySelector(`.time`);
+            if (state.time) time.textContent = state.time;
+            time.classList.toggle(`stopped`, !state.isRunning);
+            element.querySelector(`.shot`).textContent = state.shotClock !== undefined ? `SHOT ` + state.shotClock : ``;
+            if (state.home) element.querySelector(`.home`).textContent = state.home;
+            if (state.away) element.querySelector(`.away`).textContent = state.away;
+        }
+
+        function resync() {
+            if (ws && ws.readyState === WebSocket.OPEN) ws.send(JSON.stringify({command: `getCurrentData`}));
+        }
+
+        function handleMessage(message) {
+            if (message.type === `snapshot`) {
+                fields = message.fields;
+                hubSeq = message.hubSeq;
+                Object.keys(fields).forEach(render);
+                return;
+            }
+            if (message.hubSeq <= hubSeq) return; // Already in the snapshot
+            if (hubSeq < 0 || message.hubSeq !== hubSeq + 1) {
+                // Missed something, start over from a fresh snapshot
+                hubSeq = -1;
+                resync();
+                return;
+            }
+            hubSeq = message.hubSeq;
+
+            if (message.type === `field`) {
+                var field = fields[message.field] || (fields[message.field] = {state: {}});
+                field.label = message.label;
+                field.address = message.address;
+                field.online = message.online;
+            } else if (message.type === `delta`) {
+                var state = fields[message.field].state;
+                Object.keys(message.set).forEach(function(key) { state[key] = message.set[key]; });
+                (message.unset || []).forEach(function(key) { delete state[key]; });
+            }
+            render(message.field);
+        }
+
+        function connect() {
+            ws = new WebSocket(`ws://` + location.host + `/ws`);
+            ws.onopen = function() {
+                statusDisplay.textContent = `Connected`;
+                statusDisplay.classList.remove(`disconnected`);
+            };
+            ws.onclose = function() {
+                statusDisplay.textContent = `Disconnected - retrying`;
+                statusDisplay.classList.add(`disconnected`);
+                hubSeq = -1;
+                setTimeout(connect, 3000);
+            };
+            ws.onmessage = function(event) {
+                try {
+                    handleMessage(JSON.parse(event.data));
+                } catch (e) {
+                    console.error(`Error parsing data:`, e);
+                }
+            };
+        }
+
+        connect();
+    </script>
+</body>
+</html>
+)";
+
+#endif // HUB_PAGE_H
@@ -0,0 +1,205 @@
+#include "HubState.h"
+
+#include <stdio.h>
+#include <string.h>
+
+// Stamps on the bridge's own clock, meaningless to hub viewers
+static bool isBridgeStamp(const std::string& member) {
+    return member == "ts" || member == "bt" || member == "clockTs" || member == "shotTs";
+}
+
+static size_t skipSpace(const std::string& text, size_t pos) {
+    while (pos < text.size() && (text[pos] == ' ' || text[pos] == '\t' || text[pos] == '\r' || text[pos] == '\n')) pos++;
+    return pos;
+}
+
+// pos is on the opening quote, returns the position after the closing one
+static size_t skipString(const std::string& text, size_t pos) {
+    for (pos++; pos < text.size(); pos++) {
+        if (text[pos] == '\\') {
+            pos++;
+        } else if (text[pos] == '"') {
+            return pos + 1;
+        }
+    }
+    return std::string::npos;
+}
+
+static size_t skipValue(const std::string& text, size_t pos) {
+    if (pos >= text.size()) return std::string::npos;
+    if (text[pos] == '"') return skipString(text, pos);
+
+    if (text[pos] == '{' || text[pos] == '[') {
+        int depth = 0;
+        while (pos < text.size()) {
+            char c = text[pos];
+            if (c == '"') {
+                pos = skipString(text, pos);
+                if (pos == std::string::npos) return pos;
+                continue;
+            }
+            if (c == '{' || c == '[') depth++;
+            if (c == '}' || c == ']') {
+                if (--depth == 0) return pos + 1;
+            }
+            pos++;
+        }
+        return std::string::npos;
+    }
+
+    // Number, true, false or null
+    size_t start = pos;
+    while (pos < text.size() && strchr(",}] \t\r\n", text[pos]) == nullptr) pos++;
+    return pos > start ? pos : std::string::npos;
+}
+
+bool splitJsonObject(const std::string& text, JsonMembers& members) {
+    members.clear();
+    size_t pos = skipSpace(text, 0);
+    if (pos >= text.size() || text[pos] != '{') return false;
+    pos = skipSpace(text, pos + 1);
+    if (pos < text.size() && text[pos] == '}') return true;
+
+    while (pos < text.size()) {
+        if (text[pos] != '"') return false;
+        size_t keyEnd = skipString(text, pos);
+        if (keyEnd == std::string::npos) return false;
+        std::string key = text.substr(pos + 1, keyEnd - pos - 2);
+
+        pos = skipSpace(text, keyEnd);
+        if (pos >= text.size() || text[pos] != ':') return false;
+        pos = skipSpace(text, pos + 1);
+        size_t valueEnd = skipValue(text, pos);
+        if (valueEnd == std::string::npos) return false;
+        members.emplace_back(key, text.substr(pos, valueEnd - pos));
+
+        pos = skipSpace(text, valueEnd);
+        if (pos >= text.size()) return false;
+        if (text[pos] == '}') return true;
+        if (text[pos] != ',') return false;
+        pos = skipSpace(text, pos + 1);
+    }
+    return false;
+}
+
+std::string jsonQuote(const std::string& text) {
+    std::string out = "\"";
+    for (unsigned char c : text) {
+        if (c == '"' || c == '\\') {
+            out += '\\';
+            out += (char)c;
+        } else if (c < 0x20) {
+            char escaped[8];
+            snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+            out += escaped;
+        } else {
+            out += (char)c;
+        }
+    }
+    out += '"';
+    return out;
+}
+
+static std::string fieldMessage(uint64_t sequence, const std::string& id, const HubState::Field& field) {
+    return "{\"type\":\"field\",\"hubSeq\":" + std::to_string(sequence) +
+           ",\"field\":" + jsonQuote(id) +
+           ",\"label\":" + jsonQuote(field.label) +
+           ",\"address\":" + jsonQuote(field.address) +
+           ",\"online\":" + (field.online ? "true" : "false") + "}";
+}
+
+std::string HubState::addField(const std::string& id, const std::string& label, const std::string& address) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto existing = fields.find(id);
+    if (existing != fields.end() && existing->second.label == label && existing->second.address == address) {
+        return "";
+    }
+
+    Field& field = fields[id];
+    field.label = label;
+    field.address = address;
+    return fieldMessage(++sequence, id, field);
+}
+
+std::string HubState::setOnline(const std::string& id, bool online) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto found = fields.find(id);
+    if (found == fields.end() || found->second.online == online) return "";
+
+    // The last known state stays on the overview while the bridge is away
+    found->second.online = online;
+    return fieldMessage(++sequence, id, found->second);
+}
+
+std::string HubState::applyState(const std::string& id, const std::string& text) {
+    JsonMembers members;
+    if (!splitJsonObject(text, members)) return "";
+
+    std::lock_guard<std::mutex> lock(mutex);
+    auto found = fields.find(id);
+    if (found == fields.end()) return "";
+    Field& field = found->second;
+    field.updates++;
+
+    std::map<std::string, std::string> next;
+    std::string set;
+    for (const auto& member : members) {
+        if (isBridgeStamp(member.first)) continue;
+        next[member.first] = member.second;
+        auto previous = field.state.find(member.first);
+        if (previous != field.state.end() && previous->second == member.second) continue;
+        if (!set.empty()) set += ',';
+        set += "\"" + member.first + "\":" + member.second;
+    }
+
+    std::string unset;
+    for (const auto& previous : field.state) {
+        if (next.count(previous.first)) continue;
+        if (!unset.empty()) unset += ',';
+        unset += "\"" + previous.first + "\"";
+    }
+
+    if (set.empty() && unset.empty()) return "";  // A heartbeat
+    field.state.swap(next);
+    field.deltas++;
+
+    std::string message = "{\"type\":\"delta\",\"hubSeq\":" + std::to_string(++sequence) +
+                          ",\"field\":" + jsonQuote(id) + ",\"set\":{" + set + "}";
+    if (!unset.empty()) message += ",\"unset\":[" + unset + "]";
+    message += "}";
+    return message;
+}
+
+std::string HubState::snapshot() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    std::string message = "{\"type\":\"snapshot\",\"hubSeq\":" + std::to_string(sequence) + ",\"fields\":{";
+    bool firstField = true;
+    for (const auto& entry : fields) {
+        const Field& field = entry.second;
+        if (!firstField) message += ',';
+        firstField = false;
+
+        message += jsonQuote(entry.first) + ":{\"label\":" + jsonQuote(field.label) +
+                   ",\"address\":" + jsonQuote(field.address) +
+                   ",\"online\":" + (field.online ? "true" : "false") + ",\"state\":{";
+        bool firstMember = true;
+        for (const auto& member : field.state) {
+            if (!firstMember) message += ',';
+            firstMember = false;
+            message += "\"" + member.first + "\":" + member.second;
+        }
+        message += "}}";
+    }
+    message += "}}";
+    return message;
+}
+
+uint64_t HubState::getSequence() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return sequence;
+}
+
+std::map<std::string, HubState::Field> HubState::getFields() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return fields;
+}
@@ -0,0 +1,58 @@
+#ifndef HUB_STATE_H
+#define HUB_STATE_H
+
+#include <stdint.h>
+#include <map>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+// A JSON object's top level members: name as written between its quotes, value as raw
+// JSON text ("\"12:00\"", "true", "7")
+typedef std::vector<std::pair<std::string, std::string>> JsonMembers;
+
+// Splits a JSON object into its members without decoding the values.
+// Nested objects and arrays are kept whole. Returns false if text isn't an object.
+bool splitJsonObject(const std::string& text, JsonMembers& members);
+
+std::string jsonQuote(const std::string& text);
+
+// Latest state of every field in a tournament, and the combined feed built from it.
+//
+// Viewers get one snapshot of all fields, then a delta for every change carrying only the
+// members that changed. Every message has a hub sequence number; a viewer that sees a gap
+// asks for a new snapshot. Bridge clock stamps (ts, bt, ...) are dropped, they mean
+// nothing on the hub's viewers and would turn every heartbeat into a delta.
+class HubState {
+public:
+    struct Field {
+        std::string label;
+        std::string address;   // "host:port" of the bridge
+        bool online = false;
+        std::map<std::string, std::string> state;  // Member -> raw JSON value
+        uint64_t updates = 0;    // State messages from the bridge
+        uint64_t deltas = 0;     // Of those, ones that changed something
+    };
+
+private:
+    mutable std::mutex mutex;
+    std::map<std::string, Field> fields;  // By field id
+    uint64_t sequence = 0;
+
+public:
+    // Each returns the message to broadcast, or "" when viewers don't need to hear about it
+
+    // Adds a field, or updates its label and address. Fields are never removed,
+    // a bridge that goes away stays on the overview as offline.
+    std::string addField(const std::string& id, const std::string& label, const std::string& address);
+    std::string setOnline(const std::string& id, bool online);
+    // A state message from the field's bridge
+    std::string applyState(const std::string& id, const std::string& text);
+
+    std::string snapshot() const;
+    uint64_t getSequence() const;
+    std::map<std::string, Field> getFields() const;
+};
+
+#endif // HUB_STATE_H
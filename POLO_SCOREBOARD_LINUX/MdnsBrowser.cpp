@@ -0,0 +1,240 @@
+#include "MdnsBrowser.h"
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <algorithm>
+#include <chrono>
+
+static const char* MDNS_GROUP = "224.0.0.251";
+static const uint16_t MDNS_PORT = 5353;
+
+enum DnsType {
+    DNS_TYPE_A = 1,
+    DNS_TYPE_PTR = 12,
+    DNS_TYPE_SRV = 33
+};
+
+static long long nowMs() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static std::string lowerCase(std::string text) {
+    std::transform(text.begin(), text.end(), text.begin(), [](unsigned char c) { return (char)tolower(c); });
+    return text;
+}
+
+static uint16_t readU16(const uint8_t* p) {
+    return (uint16_t)((p[0] << 8) | p[1]);
+}
+
+// Reads a possibly compressed name at offset and moves offset past it
+static bool readName(const uint8_t* data, size_t length, size_t& offset, std::string& name) {
+    name.clear();
+    size_t pos = offset;
+    bool jumped = false;
+    int jumps = 0;
+
+    while (pos < length) {
+        uint8_t labelLength = data[pos];
+        if (labelLength == 0) {
+            if (!jumped) offset = pos + 1;
+            return true;
+        }
+        if ((labelLength & 0xC0) == 0xC0) {
+            if (pos + 1 >= length || ++jumps > 32) return false;
+            if (!jumped) offset = pos + 2;
+            jumped = true;
+            pos = ((labelLength & 0x3F) << 8) | data[pos + 1];
+            continue;
+        }
+        if (pos + 1 + labelLength > length) return false;
+        if (!name.empty()) name += '.';
+        name.append((const char*)data + pos + 1, labelLength);
+        pos += 1 + labelLength;
+    }
+    return false;
+}
+
+static void writeName(std::string& packet, const std::string& name) {
+    size_t start = 0;
+    while (start < name.size()) {
+        size_t dot = name.find('.', start);
+        if (dot == std::string::npos) dot = name.size();
+        size_t labelLength = std::min<size_t>(dot - start, 63);
+        packet += (char)labelLength;
+        packet.append(name, start, labelLength);
+        start = dot + 1;
+    }
+    packet += '\0';
+}
+
+MdnsBrowser::~MdnsBrowser() {
+    close();
+}
+
+bool MdnsBrowser::open(const std::string& interfaceAddress) {
+    close();
+
+    sock = socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+    if (sock < 0) {
+        lastError = std::string("Socket failed: ") + strerror(errno);
+        return false;
+    }
+
+    // mDNS packets must go out with TTL 255
+    int ttl = 255;
+    setsockopt(sock, IPPROTO_IP, IP_MULTICAST_TTL, &ttl, sizeof(ttl));
+
+    if (!interfaceAddress.empty()) {
+        in_addr iface;
+        if (inet_pton(AF_INET, interfaceAddress.c_str(), &iface) != 1 ||
+            setsockopt(sock, IPPROTO_IP, IP_MULTICAST_IF, &iface, sizeof(iface)) < 0) {
+            lastError = "Bad interface address " + interfaceAddress;
+            close();
+            return false;
+        }
+    }
+    return true;
+}
+
+void MdnsBrowser::close() {
+    if (sock >= 0) {
+        ::close(sock);
+        sock = -1;
+    }
+}
+
+bool MdnsBrowser::sendQuery(const std::string& name, uint16_t type) {
+    // Header: id 0, standard query, one question
+    std::string packet(12, '\0');
+    packet[5] = 1;
+    writeName(packet, name);
+    packet += (char)(type >> 8);
+    packet += (char)(type & 0xFF);
+    packet += '\0';
+    packet += '\1';  // Class IN
+
+    sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(MDNS_PORT);
+    inet_pton(AF_INET, MDNS_GROUP, &addr.sin_addr);
+    if (sendto(sock, packet.data(), packet.size(), 0, (sockaddr*)&addr, sizeof(addr)) < 0) {
+        lastError = std::string("Query failed: ") + strerror(errno);
+        return false;
+    }
+    return true;
+}
+
+void MdnsBrowser::collect(int timeoutMs) {
+    long long deadline = nowMs() + timeoutMs;
+    uint8_t buffer[9000];
+
+    for (;;) {
+        long long remaining = deadline - nowMs();
+        if (remaining <= 0) return;
+
+        pollfd pfd = {sock, POLLIN, 0};
+        int ready = poll(&pfd, 1, (int)remaining);
+        if (ready < 0 && errno != EINTR) return;
+        if (ready <= 0) continue;
+
+        ssize_t received = recv(sock, buffer, sizeof(buffer), 0);
+        if (received >= 12) parsePacket(buffer, (size_t)received);
+    }
+}
+
+void MdnsBrowser::parsePacket(const uint8_t* data, size_t length) {
+    if (!(data[2] & 0x80)) return;  // Not a response
+
+    uint16_t questions = readU16(data + 4);
+    uint16_t records = readU16(data + 6) + readU16(data + 8) + readU16(data + 10);
+    size_t offset = 12;
+    std::string name;
+
+    for (uint16_t i = 0; i < questions; i++) {
+        if (!readName(data, length, offset, name) || offset + 4 > length) return;
+        offset += 4;
+    }
+
+    // Answers, authority and additional records are all worth keeping
+    for (uint16_t i = 0; i < records; i++) {
+        if (!readName(data, length, offset, name) || offset + 10 > length) return;
+        uint16_t type = readU16(data + offset);
+        uint16_t rdLength = readU16(data + offset + 8);
+        size_t rdata = offset + 10;
+        if (rdata + rdLength > length) return;
+        offset = rdata + rdLength;
+
+        std::string key = lowerCase(name);
+        if (type == DNS_TYPE_PTR) {
+            std::string target;
+            size_t pos = rdata;
+            if (!readName(data, length, pos, target)) continue;
+            std::vector<std::string>& instances = pointers[key];
+            if (std::find(instances.begin(), instances.end(), target) == instances.end()) {
+                instances.push_back(target);
+            }
+        } else if (type == DNS_TYPE_SRV && rdLength >= 7) {
+            std::string target;
+            size_t pos = rdata + 6;
+            if (!readName(data, length, pos, target)) continue;
+            services[key] = std::make_pair(target, readU16(data + rdata + 4));
+        } else if (type == DNS_TYPE_A && rdLength == 4) {
+            char text[INET_ADDRSTRLEN];
+            inet_ntop(AF_INET, data + rdata, text, sizeof(text));
+            addresses[key] = text;
+        }
+    }
+}
+
+std::vector<MdnsService> MdnsBrowser::browse(const std::string& service, int timeoutMs) {
+    std::vector<MdnsService> found;
+    if (sock < 0) {
+        lastError = "Not open";
+        return found;
+    }
+
+    // Addresses change with DHCP, start from a clean slate every time
+    pointers.clear();
+    services.clear();
+    addresses.clear();
+
+    if (!sendQuery(service, DNS_TYPE_PTR)) return found;
+    collect(timeoutMs);
+
+    // Responders usually send SRV and A along with the PTR, ask for whatever was left out
+    const std::vector<std::string>& instances = pointers[lowerCase(service)];
+    bool asked = false;
+    for (const std::string& instance : instances) {
+        if (services.count(lowerCase(instance)) == 0) asked |= sendQuery(instance, DNS_TYPE_SRV);
+    }
+    if (asked) collect(timeoutMs / 2);
+
+    asked = false;
+    for (const auto& entry : services) {
+        if (addresses.count(lowerCase(entry.second.first)) == 0) asked |= sendQuery(entry.second.first, DNS_TYPE_A);
+    }
+    if (asked) collect(timeoutMs / 2);
+
+    for (const std::string& instance : instances) {
+        auto srv = services.find(lowerCase(instance));
+        if (srv == services.end()) continue;
+        auto address = addresses.find(lowerCase(srv->second.first));
+        if (address == addresses.end()) continue;
+
+        MdnsService entry;
+        entry.instance = instance;
+        entry.host = srv->second.first;
+        entry.address = address->second;
+        entry.port = srv->second.second;
+        found.push_back(entry);
+    }
+    return found;
+}
@@ -0,0 +1,52 @@
+#ifndef MDNS_BROWSER_H
+#define MDNS_BROWSER_H
+
+#include <stdint.h>
+#include <map>
+#include <string>
+#include <vector>
+
+// One service instance found on the LAN
+struct MdnsService {
+    std::string instance;   // "scoreboard._http._tcp.local"
+    std::string host;       // "scoreboard-2.local"
+    std::string address;    // Dotted IPv4
+    uint16_t port = 0;
+};
+
+// Minimal mDNS (RFC 6762) service browser, no avahi needed. Queries are sent from an
+// ephemeral port, so responders answer by unicast ("legacy unicast") and the browser
+// never has to share port 5353 with a system daemon. IPv4 only, like the bridge.
+class MdnsBrowser {
+private:
+    int sock = -1;
+    std::string lastError;
+
+    // Records seen so far, keyed by lower-case name
+    std::map<std::string, std::vector<std::string>> pointers;   // PTR: service -> instances
+    std::map<std::string, std::pair<std::string, uint16_t>> services; // SRV: instance -> host, port
+    std::map<std::string, std::string> addresses;               // A: host -> address
+
+    bool sendQuery(const std::string& name, uint16_t type);
+    void collect(int timeoutMs);
+    void parsePacket(const uint8_t* data, size_t length);
+
+public:
+    MdnsBrowser() {}
+    ~MdnsBrowser();
+
+    MdnsBrowser(const MdnsBrowser&) = delete;
+    MdnsBrowser& operator=(const MdnsBrowser&) = delete;
+
+    // interfaceAddress picks the interface queries go out on, empty for the default route
+    bool open(const std::string& interfaceAddress = "");
+    void close();
+
+    // Asks for every instance of service (e.g. "_http._tcp.local") and waits up to
+    // timeoutMs for answers, following up on instances whose host or address was missing
+    std::vector<MdnsService> browse(const std::string& service, int timeoutMs);
+
+    const std::string& getLastError() const { return lastError; }
+};
+
+#endif // MDNS_BROWSER_H
@@ -0,0 +1,159 @@
+#include "StateReceiver.h"
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+std::string ScoreState::timeFormatted() const {
+    char buf[8];
+    snprintf(buf, sizeof(buf), "%02d:%02d", minutes % 100, seconds % 100);
+    return buf;
+}
+
+std::string ScoreState::shotClockFormatted() const {
+    char buf[8];
+    snprintf(buf, sizeof(buf), "%02d:%02d", shotMinutes % 100, shotSeconds % 100);
+    return buf;
+}
+
+StateReceiver::~StateReceiver() {
+    close();
+}
+
+bool StateReceiver::open(const std::string& group, uint16_t port, const std::string& interfaceAddress) {
+    close();
+
+    sock = socket(AF_INET, SOCK_DGRAM, 0);
+    if (sock < 0) return false;
+
+    // Several listeners on the same box share the port
+    int reuse = 1;
+    setsockopt(sock, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+#ifdef SO_REUSEPORT
+    setsockopt(sock, SOL_SOCKET, SO_REUSEPORT, &reuse, sizeof(reuse));
+#endif
+
+    sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    if (bind(sock, (sockaddr*)&addr, sizeof(addr)) < 0) {
+        close();
+        return false;
+    }
+
+    ip_mreq mreq;
+    memset(&mreq, 0, sizeof(mreq));
+    if (inet_pton(AF_INET, group.c_str(), &mreq.imr_multiaddr) != 1) {
+        close();
+        errno = EINVAL;
+        return false;
+    }
+    mreq.imr_interface.s_addr = htonl(INADDR_ANY);
+    if (!interfaceAddress.empty() &&
+        inet_pton(AF_INET, interfaceAddress.c_str(), &mreq.imr_interface) != 1) {
+        close();
+        errno = EINVAL;
+        return false;
+    }
+    if (setsockopt(sock, IPPROTO_IP, IP_ADD_MEMBERSHIP, &mreq, sizeof(mreq)) < 0) {
+        close();
+        return false;
+    }
+
+    return true;
+}
+
+void StateReceiver::close() {
+    if (sock >= 0) {
+        ::close(sock);
+        sock = -1;
+    }
+}
+
+ReceiveResult StateReceiver::receive(int timeoutMs) {
+    if (sock < 0) {
+        errno = EBADF;
+        return RECEIVE_ERROR;
+    }
+
+    pollfd pfd;
+    pfd.fd = sock;
+    pfd.events = POLLIN;
+    pfd.revents = 0;
+    int ready = poll(&pfd, 1, timeoutMs);
+    if (ready < 0) return errno == EINTR ? RECEIVE_TIMEOUT : RECEIVE_ERROR;
+    if (ready == 0) return RECEIVE_TIMEOUT;
+
+    uint8_t buf[512];
+    ssize_t len = recv(sock, buf, sizeof(buf), 0);
+    if (len < 0) return errno == EINTR || errno == EAGAIN ? RECEIVE_TIMEOUT : RECEIVE_ERROR;
+
+    return handleDatagram(buf, (size_t)len);
+}
+
+ReceiveResult StateReceiver::handleDatagram(const uint8_t* data, size_t length) {
+    stats.packets++;
+
+    StatePacket packet;
+    if (!decodeStatePacket(data, length, packet)) {
+        stats.invalid++;
+        return RECEIVE_INVALID;
+    }
+    return apply(packet);
+}
+
+ReceiveResult StateReceiver::apply(const StatePacket& packet) {
+    ReceiveResult result = RECEIVE_UPDATE;
+    lastGapSize = 0;
+
+    if (state.valid) {
+        // Signed distance handles sequence wrap-around
+        int32_t delta = (int32_t)(packet.sequence - state.sequence);
+        if (packet.bootId != bootId) {
+            // Any sequence is fine after a reboot, even one just below the last
+            stats.resets++;
+            result = RECEIVE_RESET;
+        } else if (delta == 0) {
+            stats.heartbeats++;
+            result = RECEIVE_HEARTBEAT;
+        } else if (delta < 0) {
+            stats.stale++;
+            return RECEIVE_STALE;
+        } else if (delta > 1) {
+            lastGapSize = (uint32_t)(delta - 1);
+            stats.gaps++;
+            stats.lostPackets += lastGapSize;
+            result = RECEIVE_GAP;
+        }
+    }
+    if (result != RECEIVE_HEARTBEAT) stats.updates++;
+
+    // Heartbeats carry the full state too, so always take it
+    state.valid = true;
+    bootId = packet.bootId;
+    state.sequence = packet.sequence;
+    state.channel = packet.channel;
+    state.deviceType = packet.deviceType;
+    state.deviceNumber = packet.deviceNumber;
+    state.minutes = packet.minutes;
+    state.seconds = packet.seconds;
+    state.tenths = packet.tenths;
+    state.homeScore = packet.homeScore;
+    state.awayScore = packet.awayScore;
+    state.phase = packet.phase;
+    state.running = (packet.flags & STATE_FLAG_RUNNING) != 0;
+    state.test = (packet.flags & STATE_FLAG_TEST) != 0;
+    state.backupClock = (packet.flags & STATE_FLAG_BACKUP) != 0;
+    state.hasShotClock = (packet.shotFlags & SHOT_FLAG_PRESENT) != 0;
+    state.shotRunning = (packet.shotFlags & SHOT_FLAG_RUNNING) != 0;
+    state.shotMinutes = packet.shotMinutes;
+    state.shotSeconds = packet.shotSeconds;
+    return result;
+}
@@ -0,0 +1,92 @@
+#ifndef STATE_RECEIVER_H
+#define STATE_RECEIVER_H
+
+#include <stdint.h>
+#include <string>
+#include "StatePacket.h"
+
+// State reconstructed from the multicast datagrams
+struct ScoreState {
+    bool valid = false;
+    uint32_t sequence = 0;
+    int channel = 0;
+    char deviceType = 'D';
+    char deviceNumber = '0';
+    int minutes = 0;
+    int seconds = 0;
+    int tenths = 0;
+    int homeScore = 0;
+    int awayScore = 0;
+    int phase = 0;
+    bool running = false;
+    bool test = false;
+    bool backupClock = false;   // Game clock fed by the bridge's backup console
+    bool hasShotClock = false;  // Bridge has a shot clock controller attached
+    bool shotRunning = false;
+    int shotMinutes = 0;
+    int shotSeconds = 0;
+
+    // "mm:ss", the same string the bridge shows
+    std::string timeFormatted() const;
+    std::string shotClockFormatted() const;
+};
+
+// What a received datagram meant for the stream
+enum ReceiveResult {
+    RECEIVE_TIMEOUT,    // Nothing arrived in time
+    RECEIVE_UPDATE,     // Next sequence number, state updated
+    RECEIVE_GAP,        // State updated, but one or more packets were missed
+    RECEIVE_HEARTBEAT,  // Same sequence as the current state
+    RECEIVE_STALE,      // Older than the current state (reordered), ignored
+    RECEIVE_RESET,      // New boot id, the bridge restarted
+    RECEIVE_INVALID,    // Not a state packet
+    RECEIVE_ERROR       // Socket error, see errno
+};
+
+struct ReceiverStats {
+    unsigned long packets = 0;
+    unsigned long updates = 0;
+    unsigned long heartbeats = 0;
+    unsigned long gaps = 0;
+    unsigned long lostPackets = 0;
+    unsigned long stale = 0;
+    unsigned long resets = 0;
+    unsigned long invalid = 0;
+};
+
+class StateReceiver {
+private:
+    int sock = -1;
+    ScoreState state;
+    ReceiverStats stats;
+    uint32_t lastGapSize = 0;
+    uint32_t bootId = 0;
+
+    ReceiveResult apply(const StatePacket& packet);
+
+public:
+    StateReceiver() {}
+    ~StateReceiver();
+
+    StateReceiver(const StateReceiver&) = delete;
+    StateReceiver& operator=(const StateReceiver&) = delete;
+
+    // Joins the group on the given interface address (empty for the default interface)
+    bool open(const std::string& group = STATE_MULTICAST_GROUP,
+              uint16_t port = STATE_MULTICAST_PORT,
+              const std::string& interfaceAddress = "");
+    void close();
+
+    // Waits up to timeoutMs (-1 forever) for one datagram
+    ReceiveResult receive(int timeoutMs);
+
+    // Feeds a datagram that arrived some other way (tests, pcap replay)
+    ReceiveResult handleDatagram(const uint8_t* data, size_t length);
+
+    int fd() const { return sock; }
+    const ScoreState& getState() const { return state; }
+    const ReceiverStats& getStats() const { return stats; }
+    uint32_t getLastGapSize() const { return lastGapSize; }
+};
+
+#endif // STATE_RECEIVER_H
@@ -0,0 +1,234 @@
+#include "WebProtocol.h"
+
+#include <ctype.h>
+#include <stdlib.h>
+#include <string.h>
+#include <random>
+
+static std::string toLower(std::string value) {
+    for (size_t i = 0; i < value.size(); i++) value[i] = (char)tolower((unsigned char)value[i]);
+    return value;
+}
+
+static std::string trim(const std::string& value) {
+    size_t start = value.find_first_not_of(" \t");
+    if (start == std::string::npos) return "";
+    size_t end = value.find_last_not_of(" \t\r");
+    return value.substr(start, end - start + 1);
+}
+
+std::string HttpRequest::header(const std::string& name) const {
+    std::map<std::string, std::string>::const_iterator it = headers.find(name);
+    return it == headers.end() ? std::string() : it->second;
+}
+
+bool HttpRequest::isWebSocketUpgrade() const {
+    return toLower(header("upgrade")) == "websocket" &&
+           toLower(header("connection")).find("upgrade") != std::string::npos &&
+           !header("sec-websocket-key").empty();
+}
+
+bool parseHttpRequest(const std::string& head, HttpRequest& request) {
+    size_t lineEnd = head.find("\r\n");
+    std::string requestLine = head.substr(0, lineEnd);
+
+    size_t firstSpace = requestLine.find(' ');
+    size_t secondSpace = requestLine.find(' ', firstSpace + 1);
+    if (firstSpace == std::string::npos || secondSpace == std::string::npos) return false;
+
+    request.method = requestLine.substr(0, firstSpace);
+    std::string target = requestLine.substr(firstSpace + 1, secondSpace - firstSpace - 1);
+    size_t question = target.find('?');
+    request.path = target.substr(0, question);
+    request.query = question == std::string::npos ? "" : target.substr(question + 1);
+    request.headers.clear();
+
+    while (lineEnd != std::string::npos) {
+        size_t start = lineEnd + 2;
+        lineEnd = head.find("\r\n", start);
+        std::string line = head.substr(start, lineEnd == std::string::npos ? std::string::npos : lineEnd - start);
+        if (line.empty()) break;
+
+        size_t colon = line.find(':');
+        if (colon == std::string::npos) continue;
+        request.headers[toLower(trim(line.substr(0, colon)))] = trim(line.substr(colon + 1));
+    }
+    return true;
+}
+
+static uint32_t rotateLeft(uint32_t value, int bits) {
+    return (value << bits) | (value >> (32 - bits));
+}
+
+std::string sha1Digest(const std::string& data) {
+    uint32_t h[5] = {0x67452301, 0xEFCDAB89, 0x98BADCFE, 0x10325476, 0xC3D2E1F0};
+
+    std::string message = data;
+    uint64_t bitLength = (uint64_t)data.size() * 8;
+    message += (char)0x80;
+    while (message.size() % 64 != 56) message += (char)0x00;
+    for (int i = 7; i >= 0; i--) message += (char)((bitLength >> (i * 8)) & 0xFF);
+
+    for (size_t chunk = 0; chunk < message.size(); chunk += 64) {
+        uint32_t w[80];
+        for (int i = 0; i < 16; i++) {
+            const unsigned char* p = (const unsigned char*)message.data() + chunk + i * 4;
+            w[i] = ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+        }
+        for (int i = 16; i < 80; i++) w[i] = rotateLeft(w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16], 1);
+
+        uint32_t a = h[0], b = h[1], c = h[2], d = h[3], e = h[4];
+        for (int i = 0; i < 80; i++) {
+            uint32_t f, k;
+            if (i < 20)      { f = (b & c) | (~b & d);           k = 0x5A827999; }
+            else if (i < 40) { f = b ^ c ^ d;                    k = 0x6ED9EBA1; }
+            else if (i < 60) { f = (b & c) | (b & d) | (c & d);  k = 0x8F1BBCDC; }
+            else             { f = b ^ c ^ d;                    k = 0xCA62C1D6; }
+            uint32_t temp = rotateLeft(a, 5) + f + e + k + w[i];
+            e = d; d = c; c = rotateLeft(b, 30); b = a; a = temp;
+        }
+        h[0] += a; h[1] += b; h[2] += c; h[3] += d; h[4] += e;
+    }
+
+    std::string digest(20, '\0');
+    for (int i = 0; i < 5; i++) {
+        digest[i * 4] = (char)(h[i] >> 24);
+        digest[i * 4 + 1] = (char)(h[i] >> 16);
+        digest[i * 4 + 2] = (char)(h[i] >> 8);
+        digest[i * 4 + 3] = (char)h[i];
+    }
+    return digest;
+}
+
+std::string base64Encode(const std::string& data) {
+    static const char alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    std::string out;
+    size_t i = 0;
+    for (; i + 2 < data.size(); i += 3) {
+        uint32_t n = ((uint8_t)data[i] << 16) | ((uint8_t)data[i + 1] << 8) | (uint8_t)data[i + 2];
+        out += alphabet[(n >> 18) & 63];
+        out += alphabet[(n >> 12) & 63];
+        out += alphabet[(n >> 6) & 63];
+        out += alphabet[n & 63];
+    }
+    if (i + 1 == data.size()) {
+        uint32_t n = (uint8_t)data[i] << 16;
+        out += alphabet[(n >> 18) & 63];
+        out += alphabet[(n >> 12) & 63];
+        out += "==";
+    } else if (i + 2 == data.size()) {
+        uint32_t n = ((uint8_t)data[i] << 16) | ((uint8_t)data[i + 1] << 8);
+        out += alphabet[(n >> 18) & 63];
+        out += alphabet[(n >> 12) & 63];
+        out += alphabet[(n >> 6) & 63];
+        out += '=';
+    }
+    return out;
+}
+
+std::string webSocketAcceptKey(const std::string& clientKey) {
+    return base64Encode(sha1Digest(clientKey + "258EAFA5-E914-47DA-95CA-C5AB0DC85B11"));
+}
+
+std::string encodeWebSocketFrame(uint8_t opcode, const char* data, size_t length, bool mask) {
+    std::string frame;
+    frame.reserve(length + 14);
+    frame += (char)(0x80 | (opcode & 0x0F));
+
+    uint8_t maskBit = mask ? 0x80 : 0x00;
+    if (length < 126) {
+        frame += (char)(maskBit | length);
+    } else if (length <= 0xFFFF) {
+        frame += (char)(maskBit | 126);
+        frame += (char)(length >> 8);
+        frame += (char)(length & 0xFF);
+    } else {
+        frame += (char)(maskBit | 127);
+        for (int i = 7; i >= 0; i--) frame += (char)(((uint64_t)length >> (i * 8)) & 0xFF);
+    }
+
+    if (!mask) {
+        frame.append(data, length);
+        return frame;
+    }
+
+    static thread_local std::mt19937 rng(std::random_device{}());
+    uint32_t key = rng();
+    char maskKey[4] = {(char)(key >> 24), (char)(key >> 16), (char)(key >> 8), (char)key};
+    frame.append(maskKey, 4);
+    for (size_t i = 0; i < length; i++) frame += (char)(data[i] ^ maskKey[i & 3]);
+    return frame;
+}
+
+void WebSocketFrameParser::feed(const char* data, size_t length) {
+    // Compact once the consumed prefix gets large
+    if (offset > 4096 && offset * 2 > buffer.size()) {
+        buffer.erase(0, offset);
+        offset = 0;
+    }
+    buffer.append(data, length);
+}
+
+WebSocketFrameParser::Result WebSocketFrameParser::next(WebSocketMessage& message) {
+    while (true) {
+        size_t available = buffer.size() - offset;
+        if (available < 2) return NEED_MORE;
+
+        const unsigned char* p = (const unsigned char*)buffer.data() + offset;
+        bool fin = (p[0] & 0x80) != 0;
+        uint8_t opcode = p[0] & 0x0F;
+        bool masked = (p[1] & 0x80) != 0;
+        uint64_t length = p[1] & 0x7F;
+        size_t headerSize = 2;
+
+        if (length == 126) {
+            if (available < 4) return NEED_MORE;
+            length = ((uint64_t)p[2] << 8) | p[3];
+            headerSize = 4;
+        } else if (length == 127) {
+            if (available < 10) return NEED_MORE;
+            length = 0;
+            for (int i = 0; i < 8; i++) length = (length << 8) | p[2 + i];
+            headerSize = 10;
+        }
+        if (length > maxMessageSize) return PROTOCOL_ERROR;
+
+        size_t maskOffset = headerSize;
+        if (masked) headerSize += 4;
+        if (available < headerSize + length) return NEED_MORE;
+
+        std::string payload((const char*)p + headerSize, (size_t)length);
+        if (masked) {
+            const unsigned char* key = p + maskOffset;
+            for (size_t i = 0; i < payload.size(); i++) payload[i] = (char)(payload[i] ^ key[i & 3]);
+        }
+        offset += headerSize + (size_t)length;
+
+        // Control frames can arrive in the middle of a fragmented message
+        if (opcode >= WS_OP_CLOSE) {
+            if (!fin) return PROTOCOL_ERROR;
+            message.opcode = opcode;
+            message.payload.swap(payload);
+            return MESSAGE;
+        }
+
+        if (opcode == WS_OP_CONTINUATION) {
+            if (!inFragment) return PROTOCOL_ERROR;
+            fragments += payload;
+        } else {
+            if (inFragment) return PROTOCOL_ERROR;
+            fragmentOpcode = opcode;
+            fragments.swap(payload);
+            inFragment = true;
+        }
+        if (fragments.size() > maxMessageSize) return PROTOCOL_ERROR;
+
+        if (fin) {
+            message.opcode = fragmentOpcode;
+            message.payload.swap(fragments);
+            fragments.clear();
+            inFragment = false;
+            return MESSAGE;
+        }
+    }
+}
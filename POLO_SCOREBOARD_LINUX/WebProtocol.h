@@ -0,0 +1,70 @@
+#ifndef WEB_PROTOCOL_H
+#define WEB_PROTOCOL_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <map>
+#include <string>
+
+// Minimal HTTP/1.1 and WebSocket (RFC 6455) pieces shared by the relay and the aggregator
+
+enum WebSocketOpcode {
+    WS_OP_CONTINUATION = 0x0,
+    WS_OP_TEXT = 0x1,
+    WS_OP_BINARY = 0x2,
+    WS_OP_CLOSE = 0x8,
+    WS_OP_PING = 0x9,
+    WS_OP_PONG = 0xA
+};
+
+struct HttpRequest {
+    std::string method;
+    std::string path;     // Without the query string
+    std::string query;
+    std::map<std::string, std::string> headers; // Lower-case names
+
+    std::string header(const std::string& name) const;
+    bool isWebSocketUpgrade() const;
+};
+
+// Parses the request line and headers (everything before the blank line)
+bool parseHttpRequest(const std::string& head, HttpRequest& request);
+
+std::string sha1Digest(const std::string& data);  // 20 raw bytes
+std::string base64Encode(const std::string& data);
+std::string webSocketAcceptKey(const std::string& clientKey);
+
+// Builds one complete frame. Clients must mask, servers must not.
+std::string encodeWebSocketFrame(uint8_t opcode, const char* data, size_t length, bool mask);
+
+inline std::string encodeWebSocketText(const std::string& text, bool mask = false) {
+    return encodeWebSocketFrame(WS_OP_TEXT, text.data(), text.size(), mask);
+}
+
+struct WebSocketMessage {
+    uint8_t opcode = WS_OP_TEXT;
+    std::string payload;
+};
+
+// Incremental frame decoder. Reassembles fragmented messages;
+// control frames are returned as soon as they complete.
+class WebSocketFrameParser {
+private:
+    std::string buffer;
+    size_t offset = 0;
+    std::string fragments;
+    uint8_t fragmentOpcode = 0;
+    bool inFragment = false;
+    size_t maxMessageSize;
+
+public:
+    enum Result { NEED_MORE, MESSAGE, PROTOCOL_ERROR };
+
+    explicit WebSocketFrameParser(size_t maxMessage = 64 * 1024) : maxMessageSize(maxMessage) {}
+
+    void feed(const char* data, size_t length);
+    Result next(WebSocketMessage& message);
+    size_t buffered() const { return buffer.size() - offset; }
+};
+
+#endif // WEB_PROTOCOL_H
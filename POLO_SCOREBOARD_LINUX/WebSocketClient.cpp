@@ -0,0 +1,207 @@
+#include "WebSocketClient.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <chrono>
+#include <random>
+
+static long long nowMs() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+WebSocketClient::~WebSocketClient() {
+    close();
+}
+
+void WebSocketClient::close() {
+    if (sock >= 0) {
+        ::close(sock);
+        sock = -1;
+    }
+    parser = WebSocketFrameParser();
+}
+
+bool WebSocketClient::connect(const std::string& host, uint16_t port, const std::string& path, int timeoutMs) {
+    close();
+
+    addrinfo hints;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo* results = nullptr;
+    std::string service = std::to_string(port);
+    int rc = getaddrinfo(host.c_str(), service.c_str(), &hints, &results);
+    if (rc != 0) {
+        lastError = std::string("Resolve failed: ") + gai_strerror(rc);
+        return false;
+    }
+
+    for (addrinfo* ai = results; ai != nullptr && sock < 0; ai = ai->ai_next) {
+        int fd = socket(ai->ai_family, ai->ai_socktype | SOCK_CLOEXEC, ai->ai_protocol);
+        if (fd < 0) continue;
+
+        // Non-blocking connect so the timeout applies
+        int flags = fcntl(fd, F_GETFL, 0);
+        fcntl(fd, F_SETFL, flags | O_NONBLOCK);
+        int result = ::connect(fd, ai->ai_addr, ai->ai_addrlen);
+        if (result < 0 && errno == EINPROGRESS) {
+            pollfd pfd = {fd, POLLOUT, 0};
+            int error = 0;
+            socklen_t len = sizeof(error);
+            if (poll(&pfd, 1, timeoutMs) == 1 &&
+                getsockopt(fd, SOL_SOCKET, SO_ERROR, &error, &len) == 0 && error == 0) {
+                result = 0;
+            } else {
+                lastError = std::string("Connect failed: ") + strerror(error ? error : ETIMEDOUT);
+            }
+        } else if (result < 0) {
+            lastError = std::string("Connect failed: ") + strerror(errno);
+        }
+
+        if (result == 0) {
+            fcntl(fd, F_SETFL, flags);
+            int noDelay = 1;
+            setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+            sock = fd;
+        } else {
+            ::close(fd);
+        }
+    }
+    freeaddrinfo(results);
+    if (sock < 0) return false;
+
+    std::random_device rd;
+    std::string nonce(16, '\0');
+    for (size_t i = 0; i < nonce.size(); i++) nonce[i] = (char)(rd() & 0xFF);
+
+    std::string request =
+        "GET " + path + " HTTP/1.1\r\n"
+        "Host: " + host + (port == 80 ? "" : ":" + service) + "\r\n"
+        "Upgrade: websocket\r\n"
+        "Connection: Upgrade\r\n"
+        "Sec-WebSocket-Key: " + base64Encode(nonce) + "\r\n"
+        "Sec-WebSocket-Version: 13\r\n"
+        "\r\n";
+    if (!sendAll(request) || !readHandshake(timeoutMs)) {
+        close();
+        return false;
+    }
+    return true;
+}
+
+bool WebSocketClient::readHandshake(int timeoutMs) {
+    std::string response;
+    long long deadline = nowMs() + timeoutMs;
+
+    while (response.find("\r\n\r\n") == std::string::npos) {
+        int remaining = (int)(deadline - nowMs());
+        pollfd pfd = {sock, POLLIN, 0};
+        if (remaining <= 0 || poll(&pfd, 1, remaining) != 1) {
+            lastError = "Handshake timed out";
+            return false;
+        }
+        char buf[1024];
+        ssize_t n = recv(sock, buf, sizeof(buf), 0);
+        if (n <= 0) {
+            lastError = "Connection closed during handshake";
+            return false;
+        }
+        response.append(buf, (size_t)n);
+        if (response.size() > 16384) {
+            lastError = "Handshake response too large";
+            return false;
+        }
+    }
+
+    if (response.compare(0, 12, "HTTP/1.1 101") != 0) {
+        lastError = "Upgrade refused: " + response.substr(0, response.find("\r\n"));
+        return false;
+    }
+
+    // Anything after the headers is already frame data
+    size_t bodyStart = response.find("\r\n\r\n") + 4;
+    if (bodyStart < response.size()) parser.feed(response.data() + bodyStart, response.size() - bodyStart);
+    return true;
+}
+
+bool WebSocketClient::sendAll(const std::string& data) {
+    size_t sent = 0;
+    while (sent < data.size()) {
+        ssize_t n = send(sock, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            lastError = std::string("Send failed: ") + strerror(errno);
+            return false;
+        }
+        sent += (size_t)n;
+    }
+    return true;
+}
+
+bool WebSocketClient::sendText(const std::string& text) {
+    if (sock < 0) return false;
+    return sendAll(encodeWebSocketText(text, true));
+}
+
+WebSocketClient::ReadResult WebSocketClient::readText(std::string& text, int timeoutMs) {
+    long long deadline = nowMs() + timeoutMs;
+
+    while (sock >= 0) {
+        WebSocketMessage message;
+        WebSocketFrameParser::Result result = parser.next(message);
+        if (result == WebSocketFrameParser::PROTOCOL_ERROR) {
+            lastError = "Protocol error from upstream";
+            close();
+            return READ_CLOSED;
+        }
+        if (result == WebSocketFrameParser::MESSAGE) {
+            switch (message.opcode) {
+                case WS_OP_TEXT:
+                    text.swap(message.payload);
+                    return READ_MESSAGE;
+                case WS_OP_PING:
+                    sendAll(encodeWebSocketFrame(WS_OP_PONG, message.payload.data(), message.payload.size(), true));
+                    break;
+                case WS_OP_CLOSE:
+                    lastError = "Upstream closed the connection";
+                    sendAll(encodeWebSocketFrame(WS_OP_CLOSE, "", 0, true));
+                    close();
+                    return READ_CLOSED;
+                default:
+                    break; // Binary and pong frames are not used
+            }
+            continue;
+        }
+
+        int remaining = (int)(deadline - nowMs());
+        if (remaining <= 0) return READ_TIMEOUT;
+
+        pollfd pfd = {sock, POLLIN, 0};
+        int ready = poll(&pfd, 1, remaining);
+        if (ready < 0 && errno != EINTR) {
+            lastError = std::string("Poll failed: ") + strerror(errno);
+            close();
+            return READ_CLOSED;
+        }
+        if (ready <= 0) continue;
+
+        char buf[4096];
+        ssize_t n = recv(sock, buf, sizeof(buf), 0);
+        if (n <= 0) {
+            if (n < 0 && errno == EINTR) continue;
+            lastError = n == 0 ? "Upstream closed the connection" : std::string("Receive failed: ") + strerror(errno);
+            close();
+            return READ_CLOSED;
+        }
+        parser.feed(buf, (size_t)n);
+    }
+    return READ_CLOSED;
+}
@@ -0,0 +1,39 @@
+#ifndef WEBSOCKET_CLIENT_H
+#define WEBSOCKET_CLIENT_H
+
+#include <stdint.h>
+#include <string>
+#include "WebProtocol.h"
+
+// Blocking WebSocket client for the single upstream connection to a bridge's /ws
+class WebSocketClient {
+private:
+    int sock = -1;
+    WebSocketFrameParser parser;
+    std::string lastError;
+
+    bool sendAll(const std::string& data);
+    bool readHandshake(int timeoutMs);
+
+public:
+    enum ReadResult { READ_MESSAGE, READ_TIMEOUT, READ_CLOSED };
+
+    WebSocketClient() {}
+    ~WebSocketClient();
+
+    WebSocketClient(const WebSocketClient&) = delete;
+    WebSocketClient& operator=(const WebSocketClient&) = delete;
+
+    bool connect(const std::string& host, uint16_t port, const std::string& path, int timeoutMs);
+    void close();
+    bool isOpen() const { return sock >= 0; }
+
+    bool sendText(const std::string& text);
+
+    // Waits up to timeoutMs for the next text message. Pings are answered internally.
+    ReadResult readText(std::string& text, int timeoutMs);
+
+    const std::string& getLastError() const { return lastError; }
+};
+
+#endif // WEBSOCKET_CLIENT_H
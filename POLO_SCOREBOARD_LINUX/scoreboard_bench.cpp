@@ -0,0 +1,325 @@
+// Microbenchmarks for the bridge's hot paths: frame decoding and state serialization.
+// The on-device counterpart (with TFT rendering) is POLO_SCOREBOARD/Bench.h, served at /bench.
+//
+// --check-allocs runs a stream of changing frames through the per-frame path instead and
+// exits non-zero if any steady-state frame touches the heap.
+//
+// ArduinoJson is header-only; point ARDUINOJSON_DIR at its src/ directory to include the
+// ArduinoJson case: make bench ARDUINOJSON_DIR=~/Arduino/libraries/ArduinoJson/src
+
+#include <benchmark/benchmark.h>
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#include "FrameDecoder.h"
+#include "GameEvents.h"
+#include "StateJson.h"
+#include "StatePacket.h"
+#include "StatePipeline.h"
+
+#if __has_include(<ArduinoJson.h>)
+#define ARDUINOJSON_ENABLE_STD_STRING 1
+#include <ArduinoJson.h>
+#define HAVE_ARDUINOJSON 1
+#endif
+
+// Every heap allocation in the process goes through these, so a test can count them.
+// operator new ends up in malloc too. glibc only.
+static std::atomic<size_t> heapAllocations{0};
+
+extern "C" {
+void* __libc_malloc(size_t size);
+void* __libc_calloc(size_t count, size_t size);
+void* __libc_realloc(void* ptr, size_t size);
+
+void* malloc(size_t size) {
+    heapAllocations.fetch_add(1, std::memory_order_relaxed);
+    return __libc_malloc(size);
+}
+
+void* calloc(size_t count, size_t size) {
+    heapAllocations.fetch_add(1, std::memory_order_relaxed);
+    return __libc_calloc(count, size);
+}
+
+void* realloc(void* ptr, size_t size) {
+    heapAllocations.fetch_add(1, std::memory_order_relaxed);
+    return __libc_realloc(ptr, size);
+}
+}
+
+namespace {
+
+// A console frame as it arrives on the UART: STX, channel 1, T2, 12:00.99, 01 - 03, ETX
+const char kFrame[] = "\x02" "1T2120099" "0103" "\x03";
+const int kFrameLength = sizeof(kFrame) - 1;
+
+ScoreFrame decodedFrame() {
+    ScoreFrame frame;
+    decodeScoreFrame(kFrame, kFrameLength, frame);
+    return frame;
+}
+
+void BM_FrameDecode(benchmark::State& state) {
+    ScoreFrame frame;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(decodeScoreFrame(kFrame, kFrameLength, frame));
+        benchmark::ClobberMemory();
+    }
+}
+BENCHMARK(BM_FrameDecode);
+
+void BM_FrameValidate(benchmark::State& state) {
+    ScoreFrame frame = decodedFrame();
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(&frame);
+        benchmark::DoNotOptimize(isScoreFrameValid(frame));
+    }
+}
+BENCHMARK(BM_FrameValidate);
+
+void BM_FrameChanged(benchmark::State& state) {
+    ScoreFrame current = decodedFrame();
+    ScoreFrame previous = current;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(&current);
+        benchmark::DoNotOptimize(hasScoreFrameChanged(current, previous, true));
+    }
+}
+BENCHMARK(BM_FrameChanged);
+
+// The debug page's raw dump as parseMessageFormat used to build it on every frame, with String-style appends
+void BM_FrameDump_StringConcat(benchmark::State& state) {
+    for (auto _ : state) {
+        std::string hex = "Raw hex: ";
+        std::string ascii = "Raw ASCII: ";
+        for (int i = 0; i < kFrameLength; i++) {
+            char buf[5];
+            snprintf(buf, sizeof(buf), "%02X ", (unsigned char)kFrame[i]);
+            hex += buf;
+            ascii += (kFrame[i] >= 32 && kFrame[i] <= 126) ? std::string(1, kFrame[i]) : std::string(".");
+        }
+        benchmark::DoNotOptimize(hex.data());
+        benchmark::DoNotOptimize(ascii.data());
+    }
+}
+BENCHMARK(BM_FrameDump_StringConcat);
+
+// The same dump into fixed buffers, now only built in debug mode
+void BM_FrameDump_Buffer(benchmark::State& state) {
+    char hex[64];
+    char ascii[32];
+    for (auto _ : state) {
+        formatRawFrame(kFrame, kFrameLength, hex, sizeof(hex), ascii, sizeof(ascii));
+        benchmark::DoNotOptimize(hex);
+        benchmark::DoNotOptimize(ascii);
+        benchmark::ClobberMemory();
+    }
+}
+BENCHMARK(BM_FrameDump_Buffer);
+
+void BM_StateJson_Snprintf(benchmark::State& state) {
+    ScoreFrame frame = decodedFrame();
+    char buf[STATE_JSON_CAPACITY];
+    StateJsonFields fields;
+    fields.sequence = 1234;
+    fields.arrivalUs = 123456789;
+    fields.sentUs = 123459876;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(formatStateJson(buf, sizeof(buf), frame, fields));
+        benchmark::ClobberMemory();
+    }
+}
+BENCHMARK(BM_StateJson_Snprintf);
+
+// Building the message by String concatenation, one temporary per piece
+void BM_StateJson_StringConcat(benchmark::State& state) {
+    ScoreFrame frame = decodedFrame();
+    for (auto _ : state) {
+        std::string json = std::string("{\"time\":\"") + frame.timeFormatted +
+                           "\",\"home\":\"" + frame.homeScore +
+                           "\",\"away\":\"" + frame.awayScore +
+                           "\",\"deviceType\":\"" + std::string(1, frame.deviceType) + std::string(1, frame.deviceNumber) +
+                           "\",\"channel\":" + std::to_string(frame.channel) +
+                           ",\"isRunning\":" + (frame.deviceType == 'T' ? "true" : "false") +
+                           ",\"tenths\":\"" + std::string(1, frame.subSecond[0]) +
+                           "\",\"seq\":" + std::to_string(1234) +
+                           ",\"ts\":" + std::to_string(123456789) +
+                           ",\"bt\":" + std::to_string(123459876) +
+                           ",\"source\":\"scoreboard\"}";
+        benchmark::DoNotOptimize(json.data());
+    }
+}
+BENCHMARK(BM_StateJson_StringConcat);
+
+#ifdef HAVE_ARDUINOJSON
+// The document SerialHandler::sendWebSocketUpdate built before it moved to formatStateJson
+void BM_StateJson_ArduinoJson(benchmark::State& state) {
+    ScoreFrame frame = decodedFrame();
+    for (auto _ : state) {
+        StaticJsonDocument<256> doc;
+        doc["time"] = frame.timeFormatted;
+        doc["home"] = frame.homeScore;
+        doc["away"] = frame.awayScore;
+        doc["deviceType"] = std::string(1, frame.deviceType) + std::string(1, frame.deviceNumber);
+        doc["channel"] = frame.channel;
+        doc["isRunning"] = (frame.deviceType == 'T');
+        doc["tenths"] = std::string(1, frame.subSecond[0]);
+        doc["seq"] = 1234;
+        doc["ts"] = 123456789;
+        doc["bt"] = 123459876;
+        doc["source"] = "scoreboard";
+        std::string json;
+        serializeJson(doc, json);
+        benchmark::DoNotOptimize(json.data());
+    }
+}
+BENCHMARK(BM_StateJson_ArduinoJson);
+#endif
+
+// Display layout: the status line at the bottom of the scoreboard screen
+void BM_StatusLine_StringConcat(benchmark::State& state) {
+    ScoreFrame frame = decodedFrame();
+    for (auto _ : state) {
+        std::string line = "Device: " + std::string(1, frame.deviceType) +
+                           "  Channel: " + std::to_string(frame.channel);
+        benchmark::DoNotOptimize(line.data());
+    }
+}
+BENCHMARK(BM_StatusLine_StringConcat);
+
+void BM_StatusLine_Snprintf(benchmark::State& state) {
+    ScoreFrame frame = decodedFrame();
+    char buf[48];
+    for (auto _ : state) {
+        snprintf(buf, sizeof(buf), "Device: %c  Channel: %d", frame.deviceType, frame.channel);
+        benchmark::DoNotOptimize(buf);
+        benchmark::ClobberMemory();
+    }
+}
+BENCHMARK(BM_StatusLine_Snprintf);
+
+// What a changed frame goes through on the bridge before the sockets and the TFT: decode and
+// validate as SerialHandler does, then runStatePipeline() from StatePipeline.h, the function
+// SerialHandler calls, with every broadcast slot due; then the status line.
+// Instead of sending, the output keeps the last state message and packet, and numbers, keeps
+// and formats each game event the way GameEventStream::publish does before its socket sends.
+struct FramePipeline : StatePipelineOutput {
+    StatePipelineState state;
+    uint32_t arrivalUs = 0;
+    int sent = 0;
+    int events = 0;
+    GameEventHistory history;
+    char eventJson[GAME_EVENT_JSON_CAPACITY];
+    char json[STATE_JSON_CAPACITY];
+    uint8_t packet[STATE_PACKET_SIZE];
+    char statusLine[32];
+
+    void stateChanged(const StatePipelineState&, uint32_t) override {}
+
+    void gameEvent(GameEvent& event) override {
+        history.add(event);
+        if (formatGameEventJson(eventJson, sizeof(eventJson), event, arrivalUs + 100) > 0) events++;
+    }
+
+    bool isBroadcastDue(bool& newState) override {
+        newState = true;
+        return true;
+    }
+
+    void describeState(StateJsonFields& fields, StatePacket& statePacket) override {
+        fields.arrivalUs = arrivalUs;
+        fields.sentUs = arrivalUs + 250;
+        fields.shotClock = "00:30";
+        statePacket.phase = 1;
+    }
+
+    void sendState(const char* message, size_t length, const StatePacket& statePacket, bool) override {
+        memcpy(json, message, length + 1);
+        if (encodeStatePacket(statePacket, packet, sizeof(packet)) > 0) sent++;
+    }
+
+    bool process(const char* message, int length) {
+        ScoreFrame frame = state.current;
+        if (decodeScoreFrame(message, length, frame) != FRAME_DECODED || !isScoreFrameValid(frame)) return false;
+        arrivalUs += 1000;
+        if (!runStatePipeline(state, frame, arrivalUs, true, *this)) return false;
+
+        snprintf(statusLine, sizeof(statusLine), "Device: %c  Channel: %d", frame.deviceType, frame.channel);
+        return true;
+    }
+};
+
+// A chukker's worth of console frames, the clock counting down in tenths with the odd goal
+struct FrameStream {
+    static const int COUNT = 4200;
+    char frames[COUNT][20];
+    int lengths[COUNT];
+
+    FrameStream() {
+        for (int i = 0; i < COUNT; i++) {
+            int tenthsLeft = COUNT - i;
+            int goals = i / 700;
+            lengths[i] = snprintf(frames[i], sizeof(frames[i]), "\x02" "1T2%02d%02d%d0%02d%02d" "\x03",
+                                  tenthsLeft / 600, (tenthsLeft / 10) % 60, tenthsLeft % 10, goals, goals / 2);
+        }
+    }
+};
+
+void BM_FramePipeline(benchmark::State& state) {
+    static FrameStream stream;
+    FramePipeline pipeline;
+    int next = 0;
+    size_t before = heapAllocations.load();
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(pipeline.process(stream.frames[next], stream.lengths[next]));
+        next = (next + 1) % FrameStream::COUNT;
+    }
+    state.counters["allocsPerFrame"] = benchmark::Counter(
+        (double)(heapAllocations.load() - before), benchmark::Counter::kAvgIterations);
+}
+BENCHMARK(BM_FramePipeline);
+
+// The first frame may set up stdio state, every frame after that must leave the heap alone
+int checkAllocations() {
+    static FrameStream stream;
+    FramePipeline pipeline;
+    pipeline.process(stream.frames[0], stream.lengths[0]);
+
+    int processed = 0;
+    size_t before = heapAllocations.load();
+    for (int i = 1; i < FrameStream::COUNT; i++) {
+        if (pipeline.process(stream.frames[i], stream.lengths[i])) processed++;
+    }
+    size_t allocations = heapAllocations.load() - before;
+
+    printf("frame pipeline: %d frames, %d state messages, %d game events, %zu heap allocations\n",
+           processed, pipeline.sent, pipeline.events, allocations);
+    if (processed == 0 || pipeline.sent == 0 || pipeline.events == 0) {
+        printf("FAIL: no frame or game event got through the pipeline\n");
+        return 1;
+    }
+    if (allocations != 0) {
+        printf("FAIL: the steady-state frame path allocates\n");
+        return 1;
+    }
+    printf("OK\n");
+    return 0;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--check-allocs") == 0) return checkAllocations();
+    }
+
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv)) return 1;
+    benchmark::RunSpecifiedBenchmarks();
+    return 0;
+}
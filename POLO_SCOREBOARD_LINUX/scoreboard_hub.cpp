@@ -0,0 +1,314 @@
+// Tournament hub: follows every field's bridge and serves one combined feed.
+//
+// Bridges are found through the "http" mDNS service they advertise (host names starting
+// with "scoreboard") and/or listed with --bridge. The hub keeps one upstream WebSocket per
+// bridge and serves an overview page plus a /ws feed carrying a snapshot of every field,
+// then only the members that changed. Viewers never touch the ESP32s.
+//
+//   scoreboard_hub [--listen 8080] [--bridge [ID=]HOST[:PORT]]... [--no-discovery]
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "FanoutServer.h"
+#include "HubPage.h"
+#include "HubState.h"
+#include "MdnsBrowser.h"
+#include "WebSocketClient.h"
+
+static const char* BRIDGE_SERVICE = "_http._tcp.local";
+static const int DISCOVERY_INTERVAL_S = 30;
+
+static std::atomic<bool> running(true);
+
+static void handleSignal(int) {
+    running = false;
+}
+
+static void usage(const char* name) {
+    fprintf(stderr,
+            "Usage: %s [--listen PORT] [--bridge [ID=]HOST[:PORT]]... [--label ID=TEXT]... [--no-discovery]\n"
+            "          [--prefix NAME] [--iface ADDR] [--threads N] [--max-clients N] [--queue N]\n"
+            "  --listen       port to serve the overview and feed on (default 8080)\n"
+            "  --bridge       follow this bridge as field ID (default ID is the host)\n"
+            "  --label        name shown on the overview for field ID\n"
+            "  --no-discovery only follow the --bridge list\n"
+            "  --prefix       mDNS host names to treat as bridges (default scoreboard)\n"
+            "  --iface        interface address for mDNS queries\n"
+            "  --threads      worker threads (default one per core)\n"
+            "  --max-clients  connection limit (default 10000)\n"
+            "  --queue        frames queued per viewer before coalescing (default 64)\n",
+            name);
+}
+
+// Same test the relay uses: state snapshots carry the clock, debug and status messages don't
+static bool isStateMessage(const std::string& text) {
+    return text.find("\"time\":") != std::string::npos && text.find("\"type\":") == std::string::npos;
+}
+
+// Where a field's bridge is; discovery may move it when DHCP hands out a new address
+struct FieldTarget {
+    std::mutex mutex;
+    std::string host;
+    uint16_t port = 80;
+
+    void set(const std::string& newHost, uint16_t newPort) {
+        std::lock_guard<std::mutex> lock(mutex);
+        host = newHost;
+        port = newPort;
+    }
+
+    std::pair<std::string, uint16_t> get() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return std::make_pair(host, port);
+    }
+};
+
+class Hub {
+private:
+    FanoutServer& server;
+    HubState state;
+    std::map<std::string, std::string> labels;  // --label overrides
+
+    // Snapshot and broadcast change together, so a viewer's snapshot never runs
+    // ahead of or behind the deltas it gets next
+    std::mutex publishMutex;
+
+    std::mutex fieldsMutex;
+    std::map<std::string, std::shared_ptr<FieldTarget>> targets;
+    std::vector<std::thread> threads;
+
+    void publish(const std::string& message) {
+        if (message.empty()) return;
+        std::lock_guard<std::mutex> lock(publishMutex);
+        server.setSnapshot(FanoutServer::makeTextFrame(state.snapshot()));
+        server.broadcast(FanoutServer::makeTextFrame(message));
+    }
+
+    void fieldLoop(std::string id, std::shared_ptr<FieldTarget> target) {
+        WebSocketClient client;
+        int backoffMs = 1000;
+
+        while (running) {
+            std::pair<std::string, uint16_t> address = target->get();
+            if (!client.connect(address.first, address.second, "/ws", 5000)) {
+                fprintf(stderr, "Field %s (%s:%u): %s - retrying in %ds\n", id.c_str(), address.first.c_str(),
+                        address.second, client.getLastError().c_str(), backoffMs / 1000);
+                for (int waited = 0; running && waited < backoffMs; waited += 100) {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+                }
+                backoffMs = backoffMs < 10000 ? backoffMs * 2 : 10000;
+                continue;
+            }
+
+            fprintf(stderr, "Field %s connected to %s:%u\n", id.c_str(), address.first.c_str(), address.second);
+            backoffMs = 1000;
+            client.sendText("{\"command\":\"getCurrentData\"}");
+            publish(state.setOnline(id, true));
+
+            // The bridge sends a heartbeat at least every 30 s
+            int silentMs = 0;
+            while (running && client.isOpen()) {
+                std::string text;
+                WebSocketClient::ReadResult result = client.readText(text, 1000);
+                if (result == WebSocketClient::READ_MESSAGE) {
+                    silentMs = 0;
+                    if (isStateMessage(text)) publish(state.applyState(id, text));
+                } else if (result == WebSocketClient::READ_TIMEOUT) {
+                    silentMs += 1000;
+                    if (silentMs == 45000) client.sendText("{\"command\":\"getCurrentData\"}");
+                    if (silentMs >= 90000) {
+                        fprintf(stderr, "Field %s silent for 90s - reconnecting\n", id.c_str());
+                        client.close();
+                    }
+                }
+            }
+            publish(state.setOnline(id, false));
+            if (running) fprintf(stderr, "Field %s lost: %s\n", id.c_str(), client.getLastError().c_str());
+        }
+    }
+
+public:
+    explicit Hub(FanoutServer& fanout) : server(fanout) {
+        server.setSnapshot(FanoutServer::makeTextFrame(state.snapshot()));
+    }
+
+    void setLabel(const std::string& id, const std::string& label) {
+        labels[id] = label;
+    }
+
+    // Starts following a bridge, or points an existing field at its new address
+    void follow(const std::string& id, const std::string& host, uint16_t port) {
+        auto label = labels.find(id);
+        publish(state.addField(id, label != labels.end() ? label->second : id, host + ":" + std::to_string(port)));
+
+        std::lock_guard<std::mutex> lock(fieldsMutex);
+        auto existing = targets.find(id);
+        if (existing != targets.end()) {
+            existing->second->set(host, port);
+            return;
+        }
+        std::shared_ptr<FieldTarget> target = std::make_shared<FieldTarget>();
+        target->set(host, port);
+        targets[id] = target;
+        threads.emplace_back(&Hub::fieldLoop, this, id, target);
+    }
+
+    void join() {
+        std::lock_guard<std::mutex> lock(fieldsMutex);
+        for (std::thread& thread : threads) thread.join();
+        threads.clear();
+    }
+
+    SharedFrame getSnapshot() const {
+        return server.getSnapshot();
+    }
+
+    std::map<std::string, HubState::Field> getFields() const {
+        return state.getFields();
+    }
+};
+
+static void discoveryLoop(Hub& hub, std::string prefix, std::string interfaceAddress) {
+    MdnsBrowser browser;
+    if (!browser.open(interfaceAddress)) {
+        fprintf(stderr, "mDNS discovery disabled: %s\n", browser.getLastError().c_str());
+        return;
+    }
+
+    while (running) {
+        std::vector<MdnsService> services = browser.browse(BRIDGE_SERVICE, 2000);
+        for (const MdnsService& service : services) {
+            // The field id is the bridge's host name: scoreboard, scoreboard-2, ...
+            std::string id = service.host;
+            if (id.size() > 6 && id.compare(id.size() - 6, 6, ".local") == 0) id.resize(id.size() - 6);
+            std::string lower = id;
+            std::transform(lower.begin(), lower.end(), lower.begin(), [](unsigned char c) { return (char)tolower(c); });
+            if (lower.compare(0, prefix.size(), prefix) != 0) continue;
+            hub.follow(id, service.address, service.port);
+        }
+
+        for (int waited = 0; running && waited < DISCOVERY_INTERVAL_S * 10; waited++) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        }
+    }
+}
+
+int main(int argc, char** argv) {
+    FanoutOptions options;
+    std::vector<std::string> bridges;
+    std::vector<std::pair<std::string, std::string>> labels;
+    bool discovery = true;
+    std::string prefix = "scoreboard";
+    std::string interfaceAddress;
+
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--listen") && i + 1 < argc) {
+            options.port = (uint16_t)atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "--bridge") && i + 1 < argc) {
+            bridges.push_back(argv[++i]);
+        } else if (!strcmp(argv[i], "--label") && i + 1 < argc) {
+            std::string entry = argv[++i];
+            size_t equals = entry.find('=');
+            if (equals == std::string::npos) {
+                usage(argv[0]);
+                return 2;
+            }
+            labels.emplace_back(entry.substr(0, equals), entry.substr(equals + 1));
+        } else if (!strcmp(argv[i], "--no-discovery")) {
+            discovery = false;
+        } else if (!strcmp(argv[i], "--prefix") && i + 1 < argc) {
+            prefix = argv[++i];
+            std::transform(prefix.begin(), prefix.end(), prefix.begin(), [](unsigned char c) { return (char)tolower(c); });
+        } else if (!strcmp(argv[i], "--iface") && i + 1 < argc) {
+            interfaceAddress = argv[++i];
+        } else if (!strcmp(argv[i], "--threads") && i + 1 < argc) {
+            options.threads = atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "--max-clients") && i + 1 < argc) {
+            options.maxClients = (size_t)atol(argv[++i]);
+        } else if (!strcmp(argv[i], "--queue") && i + 1 < argc) {
+            options.maxQueuedFrames = (size_t)atol(argv[++i]);
+        } else {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+
+    if (!discovery && bridges.empty()) {
+        fprintf(stderr, "Nothing to follow: give --bridge or leave discovery on\n");
+        return 2;
+    }
+
+    FanoutServer server(options);
+    Hub hub(server);
+    for (const auto& label : labels) hub.setLabel(label.first, label.second);
+
+    server.addPage("/", "text/html", HUB_HTML);
+
+    // Viewers only ever ask for the current state; the hub is read-only
+    server.setMessageHandler([&hub](const std::string& text) -> SharedFrame {
+        if (text.find("\"getCurrentData\"") != std::string::npos) return hub.getSnapshot();
+        return nullptr;
+    });
+
+    signal(SIGPIPE, SIG_IGN);
+    signal(SIGINT, handleSignal);
+    signal(SIGTERM, handleSignal);
+
+    std::string error;
+    if (!server.start(error)) {
+        fprintf(stderr, "Failed to start server on port %u: %s\n", options.port, error.c_str());
+        return 1;
+    }
+    fprintf(stderr, "Serving the tournament overview on port %u\n", options.port);
+
+    for (const std::string& bridge : bridges) {
+        std::string id;
+        std::string host = bridge;
+        size_t equals = host.find('=');
+        if (equals != std::string::npos) {
+            id = host.substr(0, equals);
+            host = host.substr(equals + 1);
+        }
+        uint16_t port = 80;
+        size_t colon = host.rfind(':');
+        if (colon != std::string::npos && host.find(':') == colon) {
+            port = (uint16_t)atoi(host.c_str() + colon + 1);
+            host = host.substr(0, colon);
+        }
+        hub.follow(id.empty() ? host : id, host, port);
+    }
+
+    std::thread discoveryThread;
+    if (discovery) discoveryThread = std::thread(discoveryLoop, std::ref(hub), prefix, interfaceAddress);
+
+    int seconds = 0;
+    while (running) {
+        sleep(1);
+        if (++seconds % 60 == 0) {
+            std::map<std::string, HubState::Field> fields = hub.getFields();
+            size_t online = 0;
+            for (const auto& field : fields) online += field.second.online ? 1 : 0;
+            FanoutStats stats = server.getStats();
+            fprintf(stderr, "Fields: %zu/%zu online  Viewers: %zu  Frames queued: %zu  Bytes sent: %zu  Coalesced: %zu\n",
+                    online, fields.size(), stats.webSocketClients, stats.framesQueued, stats.bytesSent,
+                    stats.coalesced);
+        }
+    }
+
+    if (discoveryThread.joinable()) discoveryThread.join();
+    hub.join();
+    server.stop();
+    return 0;
+}
@@ -0,0 +1,122 @@
+// Prints the scoreboard state published over UDP multicast by the bridge.
+//
+//   scoreboard_listen [--group 239.255.42.42] [--port 4242] [--iface 192.168.1.20] [--json] [--heartbeats]
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+
+#include "StateReceiver.h"
+
+static volatile sig_atomic_t running = 1;
+
+static void handleSignal(int) {
+    running = 0;
+}
+
+static void usage(const char* name) {
+    fprintf(stderr,
+            "Usage: %s [--group ADDR] [--port PORT] [--iface ADDR] [--json] [--heartbeats]\n"
+            "  --group       multicast group (default %s)\n"
+            "  --port        UDP port (default %d)\n"
+            "  --iface       local interface address to join on\n"
+            "  --json        print one JSON object per update\n"
+            "  --heartbeats  also print unchanged heartbeat packets\n",
+            name, STATE_MULTICAST_GROUP, STATE_MULTICAST_PORT);
+}
+
+static void printState(const ScoreState& state, bool json) {
+    if (json) {
+        printf("{\"seq\":%u,\"time\":\"%s\",\"tenths\":%d,\"home\":\"%02d\",\"away\":\"%02d\","
+               "\"deviceType\":\"%c%c\",\"channel\":%d,\"isRunning\":%s,\"phase\":%d",
+               state.sequence, state.timeFormatted().c_str(), state.tenths,
+               state.homeScore, state.awayScore, state.deviceType, state.deviceNumber,
+               state.channel, state.running ? "true" : "false", state.phase);
+        if (state.hasShotClock) {
+            printf(",\"shotClock\":\"%s\",\"shotRunning\":%s",
+                   state.shotClockFormatted().c_str(), state.shotRunning ? "true" : "false");
+        }
+        printf("}\n");
+    } else {
+        printf("[%u] %s.%d  Home %02d - Away %02d  %s  Device: %c%c  Channel: %d",
+               state.sequence, state.timeFormatted().c_str(), state.tenths,
+               state.homeScore, state.awayScore,
+               state.running ? "RUNNING" : "STOPPED",
+               state.deviceType, state.deviceNumber, state.channel);
+        if (state.hasShotClock) {
+            printf("  Shot: %s %s", state.shotClockFormatted().c_str(), state.shotRunning ? "RUNNING" : "STOPPED");
+        }
+        printf("%s%s\n", state.backupClock ? "  (backup console)" : "", state.test ? "  (test)" : "");
+    }
+    fflush(stdout);
+}
+
+int main(int argc, char** argv) {
+    std::string group = STATE_MULTICAST_GROUP;
+    std::string iface;
+    int port = STATE_MULTICAST_PORT;
+    bool json = false;
+    bool heartbeats = false;
+
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--group") && i + 1 < argc) {
+            group = argv[++i];
+        } else if (!strcmp(argv[i], "--port") && i + 1 < argc) {
+            port = atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "--iface") && i + 1 < argc) {
+            iface = argv[++i];
+        } else if (!strcmp(argv[i], "--json")) {
+            json = true;
+        } else if (!strcmp(argv[i], "--heartbeats")) {
+            heartbeats = true;
+        } else {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+
+    StateReceiver receiver;
+    if (!receiver.open(group, (uint16_t)port, iface)) {
+        perror("Failed to join multicast group");
+        return 1;
+    }
+
+    signal(SIGINT, handleSignal);
+    signal(SIGTERM, handleSignal);
+    fprintf(stderr, "Listening on %s:%d\n", group.c_str(), port);
+
+    while (running) {
+        ReceiveResult result = receiver.receive(1000);
+        switch (result) {
+            case RECEIVE_GAP:
+                fprintf(stderr, "Gap: missed %u packet(s)\n", receiver.getLastGapSize());
+                printState(receiver.getState(), json);
+                break;
+            case RECEIVE_RESET:
+                fprintf(stderr, "New boot id - bridge rebooted\n");
+                printState(receiver.getState(), json);
+                break;
+            case RECEIVE_UPDATE:
+                printState(receiver.getState(), json);
+                break;
+            case RECEIVE_HEARTBEAT:
+                if (heartbeats) printState(receiver.getState(), json);
+                break;
+            case RECEIVE_ERROR:
+                perror("Receive failed");
+                running = 0;
+                break;
+            case RECEIVE_TIMEOUT:
+            case RECEIVE_STALE:
+            case RECEIVE_INVALID:
+                break;
+        }
+    }
+
+    const ReceiverStats& stats = receiver.getStats();
+    fprintf(stderr, "Packets: %lu  Updates: %lu  Heartbeats: %lu  Gaps: %lu  Lost: %lu  Stale: %lu  Resets: %lu  Invalid: %lu\n",
+            stats.packets, stats.updates, stats.heartbeats, stats.gaps, stats.lostPackets,
+            stats.stale, stats.resets, stats.invalid);
+    return 0;
+}
@@ -0,0 +1,159 @@
+// Relays one bridge's /ws feed to many viewers.
+//
+// Keeps a single upstream WebSocket to the bridge and re-serves the bridge's own pages
+// and feed from an epoll server spread across all cores. Every upstream message is
+// framed once and the same buffer is queued to every viewer; new viewers get the
+// latest state as soon as they connect.
+//
+//   scoreboard_relay [--upstream scoreboard.local[:80]] [--listen 8080] [--threads N] [--max-clients N]
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+
+#include "FanoutServer.h"
+#include "WebSocketClient.h"
+
+// The pages are the bridge's own, PROGMEM is an ESP32 attribute
+#define PROGMEM
+#include "WebPages.h"
+
+static std::atomic<bool> running(true);
+
+static void handleSignal(int) {
+    running = false;
+}
+
+static void usage(const char* name) {
+    fprintf(stderr,
+            "Usage: %s [--upstream HOST[:PORT]] [--listen PORT] [--threads N] [--max-clients N] [--queue N]\n"
+            "  --upstream     bridge to relay (default scoreboard.local:80)\n"
+            "  --listen       port to serve viewers on (default 8080)\n"
+            "  --threads      worker threads (default one per core)\n"
+            "  --max-clients  connection limit (default 10000)\n"
+            "  --queue        frames queued per viewer before coalescing (default 64)\n",
+            name);
+}
+
+// State snapshots are the messages carrying the clock; debug and status messages are
+// relayed but never replayed to new viewers
+static bool isStateMessage(const std::string& text) {
+    return text.find("\"time\":") != std::string::npos && text.find("\"type\":") == std::string::npos;
+}
+
+static void upstreamLoop(FanoutServer& server, std::string host, uint16_t port) {
+    WebSocketClient client;
+    int backoffMs = 1000;
+
+    while (running) {
+        if (!client.connect(host, port, "/ws", 5000)) {
+            fprintf(stderr, "Upstream %s:%u: %s - retrying in %ds\n", host.c_str(), port,
+                    client.getLastError().c_str(), backoffMs / 1000);
+            for (int waited = 0; running && waited < backoffMs; waited += 100) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            }
+            backoffMs = backoffMs < 10000 ? backoffMs * 2 : 10000;
+            continue;
+        }
+
+        fprintf(stderr, "Upstream connected to %s:%u\n", host.c_str(), port);
+        backoffMs = 1000;
+        client.sendText("{\"command\":\"getCurrentData\"}");
+
+        // The bridge sends a heartbeat at least every 30 s
+        int silentMs = 0;
+        while (running && client.isOpen()) {
+            std::string text;
+            WebSocketClient::ReadResult result = client.readText(text, 1000);
+            if (result == WebSocketClient::READ_MESSAGE) {
+                silentMs = 0;
+                SharedFrame frame = FanoutServer::makeTextFrame(text);
+                if (isStateMessage(text)) server.setSnapshot(frame);
+                server.broadcast(frame);
+            } else if (result == WebSocketClient::READ_TIMEOUT) {
+                silentMs += 1000;
+                if (silentMs == 45000) client.sendText("{\"command\":\"getCurrentData\"}");
+                if (silentMs >= 90000) {
+                    fprintf(stderr, "Upstream silent for 90s - reconnecting\n");
+                    client.close();
+                }
+            }
+        }
+        if (running) fprintf(stderr, "Upstream lost: %s\n", client.getLastError().c_str());
+    }
+}
+
+int main(int argc, char** argv) {
+    std::string upstream = "scoreboard.local";
+    FanoutOptions options;
+
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--upstream") && i + 1 < argc) {
+            upstream = argv[++i];
+        } else if (!strcmp(argv[i], "--listen") && i + 1 < argc) {
+            options.port = (uint16_t)atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "--threads") && i + 1 < argc) {
+            options.threads = atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "--max-clients") && i + 1 < argc) {
+            options.maxClients = (size_t)atol(argv[++i]);
+        } else if (!strcmp(argv[i], "--queue") && i + 1 < argc) {
+            options.maxQueuedFrames = (size_t)atol(argv[++i]);
+        } else {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+
+    std::string host = upstream;
+    uint16_t upstreamPort = 80;
+    size_t colon = upstream.rfind(':');
+    if (colon != std::string::npos && upstream.find(':') == colon) {
+        host = upstream.substr(0, colon);
+        upstreamPort = (uint16_t)atoi(upstream.c_str() + colon + 1);
+    }
+
+    FanoutServer server(options);
+    server.addPage("/", "text/html", INDEX_HTML);
+    server.addPage("/debug", "text/html", DEBUG_HTML);
+    server.addPage("/ws-shared.js", "application/javascript", WS_SHARED_JS); // Loaded by both pages
+    // Settings stay on the bridge itself, /settings falls through to the redirect
+
+    // Viewers only ever ask for the current state; the relay is read-only
+    server.setMessageHandler([&server](const std::string& text) -> SharedFrame {
+        if (text.find("\"getCurrentData\"") != std::string::npos) return server.getSnapshot();
+        return nullptr;
+    });
+
+    signal(SIGPIPE, SIG_IGN);
+    signal(SIGINT, handleSignal);
+    signal(SIGTERM, handleSignal);
+
+    std::string error;
+    if (!server.start(error)) {
+        fprintf(stderr, "Failed to start server on port %u: %s\n", options.port, error.c_str());
+        return 1;
+    }
+    fprintf(stderr, "Relaying %s:%u on port %u\n", host.c_str(), upstreamPort, options.port);
+
+    std::thread upstreamThread(upstreamLoop, std::ref(server), host, upstreamPort);
+
+    int seconds = 0;
+    while (running) {
+        sleep(1);
+        if (++seconds % 60 == 0) {
+            FanoutStats stats = server.getStats();
+            fprintf(stderr, "Viewers: %zu  HTTP requests: %zu  Frames queued: %zu  Bytes sent: %zu  Coalesced: %zu  Rejected: %zu\n",
+                    stats.webSocketClients, stats.httpRequests, stats.framesQueued, stats.bytesSent,
+                    stats.coalesced, stats.rejected);
+        }
+    }
+
+    upstreamThread.join();
+    server.stop();
+    return 0;
+}
@@ -0,0 +1,124 @@
+// Turns the folded stacks from the bridge's /profile/stacks into function names, using the
+// firmware ELF and the toolchain's addr2line. The output goes straight into flamegraph.pl.
+//
+//   scoreboard_symbolize --elf POLO_SCOREBOARD.ino.elf [--addr2line PATH] [FILE]
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <map>
+#include <string>
+#include <vector>
+
+static const char* DEFAULT_ADDR2LINE = "xtensa-esp32s3-elf-addr2line";
+static const size_t ADDRESSES_PER_CALL = 200; // Keeps the command line well under ARG_MAX
+
+static void usage(const char* name) {
+    fprintf(stderr,
+            "Usage: %s --elf FILE [--addr2line PATH] [FILE]\n"
+            "  --elf        firmware ELF the bridge is running (Arduino: Sketch > Export Compiled Binary)\n"
+            "  --addr2line  addr2line for the bridge's CPU (default %s)\n"
+            "  FILE         folded stacks from /profile/stacks (default stdin)\n",
+            name, DEFAULT_ADDR2LINE);
+}
+
+static bool isAddress(const std::string& frame) {
+    return frame.size() > 2 && frame[0] == '0' && frame[1] == 'x';
+}
+
+// Looks up addresses in batches, one addr2line run each. Unknown ones keep their address.
+static bool symbolize(const std::string& addr2line, const std::string& elf,
+                      const std::vector<std::string>& addresses, std::map<std::string, std::string>& names) {
+    for (size_t first = 0; first < addresses.size(); first += ADDRESSES_PER_CALL) {
+        size_t last = std::min(addresses.size(), first + ADDRESSES_PER_CALL);
+        std::string command = addr2line + " -f -C -e '" + elf + "'";
+        for (size_t i = first; i < last; i++) command += " " + addresses[i];
+
+        FILE* pipe = popen(command.c_str(), "r");
+        if (pipe == nullptr) {
+            perror("popen");
+            return false;
+        }
+        // Two lines per address: function, then file:line
+        char function[1024];
+        char location[1024];
+        for (size_t i = first; i < last; i++) {
+            if (!fgets(function, sizeof(function), pipe) || !fgets(location, sizeof(location), pipe)) break;
+            function[strcspn(function, "\n")] = '\0';
+            if (strcmp(function, "??") == 0) continue;
+            // Semicolons separate frames in the folded format
+            for (char* c = function; *c; c++) {
+                if (*c == ';') *c = ':';
+            }
+            names[addresses[i]] = function;
+        }
+        if (pclose(pipe) != 0) {
+            fprintf(stderr, "%s failed, is it on the PATH?\n", addr2line.c_str());
+            return false;
+        }
+    }
+    return true;
+}
+
+int main(int argc, char** argv) {
+    std::string elf;
+    std::string addr2line = DEFAULT_ADDR2LINE;
+    const char* inputPath = nullptr;
+
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--elf") && i + 1 < argc) {
+            elf = argv[++i];
+        } else if (!strcmp(argv[i], "--addr2line") && i + 1 < argc) {
+            addr2line = argv[++i];
+        } else if (argv[i][0] != '-' && inputPath == nullptr) {
+            inputPath = argv[i];
+        } else {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+    if (elf.empty()) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    FILE* input = inputPath != nullptr ? fopen(inputPath, "r") : stdin;
+    if (input == nullptr) {
+        perror(inputPath);
+        return 1;
+    }
+
+    // Each line: task;frame;...;frame count
+    std::vector<std::pair<std::vector<std::string>, std::string>> stacks;
+    std::map<std::string, std::string> names;
+    std::vector<std::string> addresses;
+    char line[4096];
+    while (fgets(line, sizeof(line), input)) {
+        line[strcspn(line, "\n")] = '\0';
+        char* space = strrchr(line, ' ');
+        if (space == nullptr) continue;
+        *space = '\0';
+
+        std::vector<std::string> frames;
+        for (char* frame = strtok(line, ";"); frame != nullptr; frame = strtok(nullptr, ";")) {
+            frames.push_back(frame);
+            if (isAddress(frames.back()) && names.emplace(frames.back(), frames.back()).second) {
+                addresses.push_back(frames.back());
+            }
+        }
+        stacks.emplace_back(frames, space + 1);
+    }
+    if (input != stdin) fclose(input);
+
+    if (!symbolize(addr2line, elf, addresses, names)) return 1;
+
+    for (const auto& stack : stacks) {
+        const std::vector<std::string>& frames = stack.first;
+        for (size_t i = 0; i < frames.size(); i++) {
+            if (i > 0) putchar(';');
+            auto name = names.find(frames[i]);
+            fputs(name != names.end() ? name->second.c_str() : frames[i].c_str(), stdout);
+        }
+        printf(" %s\n", stack.second.c_str());
+    }
+    return 0;
+}
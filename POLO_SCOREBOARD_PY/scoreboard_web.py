@@ -39,16 +39,18 @@
 #!/usr/bin/env python3
 # filepath: scoreboard_web.py
 import argparse
+import concurrent.futures
 import json
 import os
+import queue
 import re
 import serial
 import serial.tools.list_ports
 import threading
 import time
 import webbrowser
-from flask import Flask, render_template, send_from_directory
-from flask_socketio import SocketIO
+from flask import Flask, jsonify, render_template, request, send_from_directory
+from flask_socketio import SocketIO, join_room
 
 # Configure Flask app and SocketIO
 
@@ -61,6 +63,23 @@ def settings():
     global save_folder
     return render_template('settings.html', save_folder=save_folder)
 
+@app.route('/set_save_folder', methods=['POST'])
+def set_save_folder():
+    global save_folder
+    folder = ((request.get_json(silent=True) or {}).get('folder') or '').strip()
+    if not folder:
+        return jsonify(success=False, message='Enter a folder path')
+    folder = os.path.abspath(os.path.expanduser(folder))
+    try:
+        os.makedirs(folder, exist_ok=True)
+    except OSError as e:
+        return jsonify(success=False, message=f'Cannot create {folder}: {e.strerror}')
+    if not os.access(folder, os.W_OK):
+        return jsonify(success=False, message=f'Cannot write to {folder}')
+    save_folder = folder
+    overlay_writer.set_folder(folder)
+    return jsonify(success=True, message=f'Writing files to {folder}')
+
 # Global variables for data storage
 last_data = {
     "time": "00:00",
@@ -72,10 +91,226 @@ last_data = {
 ser = None
 connected = False
 
+# Auto-discovery: rates tried on each port, most common first, and how long each gets
+SUPPORTED_BAUD_RATES = [9600, 19200, 38400, 57600, 115200]
+SNIFF_SECONDS_PER_BAUD = 1.5
+SNIFF_FRAMES_REQUIRED = 2  # One valid frame can be line noise, two in a row means a console
+# Channel, device status (T/D and a number), mm ss sub-second, home, away
+FRAME_PATTERN = re.compile(r'\d[TD]\d(\d{2})([0-5]\d)\d{2}\d{2}\d{2}')
+discovery_running = threading.Lock()
+
+# Socket.IO rooms: each page joins the one for the events it shows (io({query: {room: ...}}))
+ROOM_SCOREBOARD = 'scoreboard'  # scoreboard_data, status_update
+ROOM_DEBUG = 'debug'            # raw_data, debug_data
+ROOM_SETTINGS = 'settings'      # Only port_list, which goes to whoever asked
+ROOMS = (ROOM_SCOREBOARD, ROOM_DEBUG, ROOM_SETTINGS)
+STREAM_LIMIT_PER_SECOND = 50    # raw_data and per-line debug_data each room gets, the rest are dropped
+
 # Folder to save .txt files
 save_folder = os.path.join(os.path.dirname(os.path.abspath(__file__)), 'scoreboardOutput')
 if not os.path.exists(save_folder):
     os.makedirs(save_folder)
+OVERLAY_WRITE_INTERVAL = 0.1  # Seconds, at most 10 writes a second however fast the console sends
+
+# Malformed frame log: queue limit, lines per write, rotation and how often the debug page hears about it
+MALFORMED_QUEUE_SIZE = 10000
+MALFORMED_BATCH_SIZE = 500
+MALFORMED_LOG_MAX_BYTES = 1024 * 1024
+MALFORMED_LOG_BACKUPS = 3
+MALFORMED_SUMMARY_INTERVAL = 5  # Seconds
+
+class OverlayWriter:
+    """Keeps one .txt file per field in the save folder for streaming software to read.
+
+    update() only stores the latest data, so the serial reader never waits on the disk.
+    A background thread writes at most every OVERLAY_WRITE_INTERVAL seconds, skips files
+    whose text hasn't changed, and replaces each file by writing a temporary file and renaming
+    it over the old one, so a reader never sees a half-written file.
+    """
+
+    def __init__(self, folder):
+        self.folder = folder
+        self.latest = None
+        self.written = {}  # File name -> text last written there
+        self.lock = threading.Lock()
+        self.pending = threading.Event()
+
+    def start(self):
+        threading.Thread(target=self._run, daemon=True).start()
+
+    def update(self, data):
+        with self.lock:
+            self.latest = data
+        self.pending.set()
+
+    def set_folder(self, folder):
+        with self.lock:
+            self.folder = folder
+            self.written = {}  # Everything goes into the new folder
+        self.pending.set()
+
+    def _run(self):
+        while True:
+            self.pending.wait()
+            self.pending.clear()
+            with self.lock:
+                folder = self.folder
+                data = self.latest
+            if data:
+                self._write_changed(folder, data)
+            # Updates that arrive meanwhile are coalesced into the next write
+            time.sleep(OVERLAY_WRITE_INTERVAL)
+
+    def _write_changed(self, folder, data):
+        files = {
+            'time.txt': data['time'],
+            'home.txt': data['home'],
+            'away.txt': data['away'],
+            'scoreboard.txt': f"{data['time']}  {data['home']} - {data['away']}",
+        }
+        for name, text in files.items():
+            if self.written.get(name) == text:
+                continue
+            path = os.path.join(folder, name)
+            temp_path = path + '.tmp'
+            try:
+                with open(temp_path, 'w') as f:
+                    f.write(text)
+                os.replace(temp_path, path)
+            except OSError as e:
+                # Folder gone, or on Windows the file is open in the reader: try again next write
+                self.pending.set()
+                if 'DEBUG_PRINT' in globals() and DEBUG_PRINT:
+                    print(f"[ERROR] Writing {path}: {e}")
+                continue
+            with self.lock:
+                if self.folder == folder:
+                    self.written[name] = text
+
+overlay_writer = OverlayWriter(save_folder)
+
+class MalformedLog:
+    """Logs frames that didn't parse without slowing the serial reader down.
+
+    record() only puts the line on a bounded queue (and counts it as dropped when the queue is
+    full). A background thread appends whatever has queued up to the log in one write, rotates
+    the log when it gets too big, and sends the debug page one summary every
+    MALFORMED_SUMMARY_INTERVAL seconds instead of a message per bad frame.
+    """
+
+    def __init__(self, path):
+        self.path = path
+        self.queue = queue.Queue(maxsize=MALFORMED_QUEUE_SIZE)
+        self.dropped = 0
+        self.counts = {}  # Kind -> frames since the last summary
+        self.last = None  # Newest entry since the last summary
+
+    def start(self):
+        threading.Thread(target=self._run, daemon=True).start()
+
+    def record(self, kind, data, detail=''):
+        try:
+            self.queue.put_nowait((time.time(), kind, data, detail))
+        except queue.Full:
+            self.dropped += 1  # No lock, a lost count only makes the summary a little low
+
+    def _run(self):
+        next_summary = time.monotonic() + MALFORMED_SUMMARY_INTERVAL
+        while True:
+            batch = []
+            try:
+                batch.append(self.queue.get(timeout=max(0, next_summary - time.monotonic())))
+                while len(batch) < MALFORMED_BATCH_SIZE:
+                    batch.append(self.queue.get_nowait())
+            except queue.Empty:
+                pass
+            if batch:
+                self._write(batch)
+            if time.monotonic() >= next_summary:
+                self._summarize()
+                next_summary = time.monotonic() + MALFORMED_SUMMARY_INTERVAL
+
+    def _write(self, batch):
+        lines = []
+        for stamp, kind, data, detail in batch:
+            self.counts[kind] = self.counts.get(kind, 0) + 1
+            self.last = (kind, data)
+            # Escaped, so control characters and stray bytes show up in the log
+            raw = data.encode('unicode_escape').decode('ascii')
+            when = time.strftime('%Y-%m-%d %H:%M:%S', time.localtime(stamp)) + f'.{int(stamp * 1000) % 1000:03d}'
+            lines.append(f"{when} {kind}: '{raw}' {detail}\n")
+        try:
+            if os.path.exists(self.path) and os.path.getsize(self.path) >= MALFORMED_LOG_MAX_BYTES:
+                self._rotate()
+            with open(self.path, 'a') as log_file:
+                log_file.writelines(lines)
+        except OSError as e:
+            if 'DEBUG_PRINT' in globals() and DEBUG_PRINT:
+                print(f"[ERROR] Writing {self.path}: {e}")
+
+    def _rotate(self):
+        # scoreboard_malformed.log -> .1 -> .2 ..., the oldest is deleted
+        for i in range(MALFORMED_LOG_BACKUPS - 1, 0, -1):
+            older = f'{self.path}.{i}'
+            if os.path.exists(older):
+                os.replace(older, f'{self.path}.{i + 1}')
+        os.replace(self.path, f'{self.path}.1')
+
+    def _summarize(self):
+        dropped, self.dropped = self.dropped, 0
+        if not self.counts and not dropped:
+            return
+        parts = [f'{kind}: {count}' for kind, count in self.counts.items()]
+        if dropped:
+            parts.append(f'not logged (queue full): {dropped}')
+        message = f"Last {MALFORMED_SUMMARY_INTERVAL:g}s: {', '.join(parts)}"
+        if self.last:
+            message += f" - latest: {self.last[1]!r}"
+        socketio.emit('debug_data', {
+            'message': message + f' (see {self.path})',
+            'type': 'warning'
+        }, to=ROOM_DEBUG)
+        self.counts = {}
+        self.last = None
+
+malformed_log = MalformedLog('scoreboard_malformed.log')
+
+class StreamThrottle:
+    """Caps the per-line debug streams at STREAM_LIMIT_PER_SECOND messages per event and room.
+
+    Messages over the cap are dropped and counted. With the first message of the next second the
+    room gets a debug_data warning saying how many went missing.
+    """
+
+    def __init__(self):
+        self.lock = threading.Lock()
+        self.windows = {}  # (event, room) -> [second started, sent, dropped]
+        self.dropped_total = {}  # Event -> dropped since launch
+
+    def emit(self, event, data, room):
+        now = time.monotonic()
+        with self.lock:
+            window = self.windows.setdefault((event, room), [now, 0, 0])
+            dropped = 0
+            if now - window[0] >= 1:
+                dropped = window[2]
+                window[:] = [now, 0, 0]
+            send = window[1] < STREAM_LIMIT_PER_SECOND
+            if send:
+                window[1] += 1
+            else:
+                window[2] += 1
+                self.dropped_total[event] = self.dropped_total.get(event, 0) + 1
+            total = self.dropped_total.get(event, 0)
+        if dropped:
+            socketio.emit('debug_data', {
+                'message': f'{dropped} {event} messages over {STREAM_LIMIT_PER_SECOND}/s not sent ({total} since launch)',
+                'type': 'warning'
+            }, to=room)
+        if send:
+            socketio.emit(event, data, to=room)
+
+stream_throttle = StreamThrottle()
 
 def create_template_directory(force_rebuild=False):
     # Create templates directory if needed
@@ -115,6 +350,7 @@ def create_template_directory(force_rebuild=False):
             <select id="portSelect"></select>
             <button onclick="connectPort()">Connect</button>
             <button onclick="scanPorts()">Scan Ports</button>
+            <button onclick="autoDetect()">Auto Detect</button>
         </div>
     </div>
     <div class="container">
@@ -146,8 +382,9 @@ def create_template_directory(force_rebuild=False):
             });
         }
         function scanPorts() { socket.emit('scan_ports'); }
+        function autoDetect() { socket.emit('auto_detect'); }
         function connectPort() { const port = document.getElementById('portSelect').value; if (port) socket.emit('connect_port', { port }); }
-        const socket = io();
+        const socket = io({ query: { room: 'settings' } });  // Only this page's events
         const portSelect = document.getElementById('portSelect');
         socket.on('port_list', data => {
             portSelect.innerHTML = '';
@@ -208,6 +445,7 @@ def create_template_directory(force_rebuild=False):
             <select id="portSelect"></select>
             <button onclick="connectPort()">Connect</button>
             <button onclick="scanPorts()">Scan Ports</button>
+            <button onclick="autoDetect()">Auto Detect</button>
         </div>
     </div>
     <div class="scoreboard">
@@ -234,13 +472,14 @@ def create_template_directory(force_rebuild=False):
     <script>document.getElementById('currentYear').textContent = new Date().getFullYear();</script>
     <script src="https://cdnjs.cloudflare.com/ajax/libs/socket.io/4.0.1/socket.io.js"></script>
     <script>
-        const socket = io();
+        const socket = io({ query: { room: 'scoreboard' } });  // Only this page's events
         const timeDisplay = document.getElementById('time');
         const homeDisplay = document.getElementById('home');
         const awayDisplay = document.getElementById('away');
         const statusDisplay = document.getElementById('status');
         const portSelect = document.getElementById('portSelect');
         function scanPorts() { socket.emit('scan_ports'); }
+        function autoDetect() { socket.emit('auto_detect'); }
         function connectPort() { const port = portSelect.value; if (port) socket.emit('connect_port', { port }); }
         socket.on('port_list', data => {
             portSelect.innerHTML = '';
@@ -314,6 +553,7 @@ def create_template_directory(force_rebuild=False):
             <select id="portSelect"></select>
             <button onclick="connectPort()">Connect</button>
             <button onclick="scanPorts()">Scan Ports</button>
+            <button onclick="autoDetect()">Auto Detect</button>
         </div>
     </div>
     <h1>Scoreboard Debug Monitor</h1>
@@ -324,11 +564,12 @@ def create_template_directory(force_rebuild=False):
     <div id="serialData"></div>
     <script src="https://cdnjs.cloudflare.com/ajax/libs/socket.io/4.0.1/socket.io.js"></script>
     <script>
-        const socket = io();
+        const socket = io({ query: { room: 'debug' } });  // Only this page's events
         const serialDiv = document.getElementById('serialData');
         const autoscroll = document.getElementById('autoscroll');
         const portSelect = document.getElementById('portSelect');
         function scanPorts() { socket.emit('scan_ports'); }
+        function autoDetect() { socket.emit('auto_detect'); }
         function connectPort() { const port = portSelect.value; if (port) socket.emit('connect_port', { port }); }
         socket.on('port_list', data => {
             portSelect.innerHTML = '';
@@ -369,26 +610,45 @@ def debug():
 
 @socketio.on('connect')
 def handle_connect():
-    socketio.emit('scoreboard_data', last_data)
+    room = request.args.get('room')
+    if room in ROOMS:
+        join_room(room)
+    else:
+        # Pages from before rooms existed get everything, as they used to
+        for name in ROOMS:
+            join_room(name)
+    # Only the new client needs the current state
+    socketio.emit('scoreboard_data', last_data, to=request.sid)
     status = {
         'connected': connected,
         'message': f'Connected to port {ser.port}' if connected and ser else 'Not connected to scoreboard'
     }
-    socketio.emit('status_update', status)
+    socketio.emit('status_update', status, to=request.sid)
+
+def port_list_message():
+    return {
+        'ports': list_serial_ports(),
+        'current_port': ser.port if connected and ser else None
+    }
 
 @socketio.on('scan_ports')
 def handle_scan_ports():
-    ports = list_serial_ports()
-    socketio.emit('port_list', {
-        'ports': ports,
-        'current_port': ser.port if connected and ser else None
-    })
+    socketio.emit('port_list', port_list_message(), to=request.sid)
 
 @socketio.on('connect_port')
 def handle_connect_port(data):
-    global ser, connected
     port = data.get('port')
-    
+    if port:
+        open_serial_port(port)
+
+@socketio.on('auto_detect')
+def handle_auto_detect():
+    threading.Thread(target=auto_connect, daemon=True).start()
+
+def open_serial_port(port, baudrate=9600):
+    """Close any open port, open this one and start reading it"""
+    global ser, connected
+
     # Close existing connection if open
     if ser:
         try:
@@ -397,30 +657,31 @@ def handle_connect_port(data):
             pass
         ser = None
         connected = False
-    
-    if port:
-        try:
-            ser = serial.Serial(port, baudrate=9600, timeout=1)
-            connected = True
-            socketio.emit('status_update', {
-                'connected': True,
-                'message': f'Connected to port {port}'
-            })
-            socketio.emit('debug_data', {
-                'message': f'Connected to port {port}',
-                'type': 'success'
-            })
-            # Start reading thread after successful connection
-            threading.Thread(target=serial_reader, daemon=True).start()
-        except Exception as e:
-            socketio.emit('status_update', {
-                'connected': False,
-                'message': f'Failed to connect to port {port}: {str(e)}'
-            })
-            socketio.emit('debug_data', {
-                'message': f'Connection error: {str(e)}',
-                'type': 'error'
-            })
+
+    try:
+        ser = serial.Serial(port, baudrate=baudrate, timeout=1)
+        connected = True
+        socketio.emit('status_update', {
+            'connected': True,
+            'message': f'Connected to port {port} at {baudrate} baud'
+        }, to=ROOM_SCOREBOARD)
+        socketio.emit('debug_data', {
+            'message': f'Connected to port {port} at {baudrate} baud',
+            'type': 'success'
+        }, to=ROOM_DEBUG)
+        # Start reading thread after successful connection
+        threading.Thread(target=serial_reader, daemon=True).start()
+        return True
+    except Exception as e:
+        socketio.emit('status_update', {
+            'connected': False,
+            'message': f'Failed to connect to port {port}: {str(e)}'
+        }, to=ROOM_SCOREBOARD)
+        socketio.emit('debug_data', {
+            'message': f'Connection error: {str(e)}',
+            'type': 'error'
+        }, to=ROOM_DEBUG)
+        return False
 
 def list_serial_ports():
     """List available serial ports with descriptions"""
@@ -432,6 +693,88 @@ def list_serial_ports():
         })
     return ports
 
+def sniff_port(port, stop):
+    """Listen on a port at each supported rate. Returns the rate that gave valid frames, or None."""
+    try:
+        probe = serial.Serial(port, baudrate=SUPPORTED_BAUD_RATES[0], timeout=0.2)
+    except Exception:
+        return None  # Busy, gone or not ours to open
+    try:
+        for baud in SUPPORTED_BAUD_RATES:
+            if stop.is_set():
+                return None
+            probe.baudrate = baud
+            probe.reset_input_buffer()
+            buffer = ""
+            frames = 0
+            deadline = time.monotonic() + SNIFF_SECONDS_PER_BAUD
+            while time.monotonic() < deadline and not stop.is_set():
+                buffer += probe.read(probe.in_waiting or 1).decode('utf-8', errors='ignore')
+                lines = re.split(r'[\n\t]', buffer)
+                buffer = lines[-1][-64:]  # A wrong rate never sends a delimiter, don't let it grow
+                for line in lines[:-1]:
+                    if FRAME_PATTERN.search(line):
+                        frames += 1
+                        if frames >= SNIFF_FRAMES_REQUIRED:
+                            return baud
+                    elif line.strip():
+                        frames = 0
+    except Exception:
+        return None
+    finally:
+        try:
+            probe.close()
+        except Exception:
+            pass
+    return None
+
+def discover_scoreboard_port(ports=None):
+    """Sniff every candidate port at once. Returns (port, baud) for the first console found, or None.
+
+    Takes at most len(SUPPORTED_BAUD_RATES) * SNIFF_SECONDS_PER_BAUD seconds however many ports there are."""
+    if ports is None:
+        ports = [p['name'] for p in list_serial_ports()]
+    if not ports:
+        return None
+    stop = threading.Event()
+    with concurrent.futures.ThreadPoolExecutor(max_workers=len(ports)) as pool:
+        futures = {pool.submit(sniff_port, port, stop): port for port in ports}
+        for future in concurrent.futures.as_completed(futures):
+            baud = future.result()
+            if baud:
+                stop.set()  # The others give up at their next read
+                return futures[future], baud
+    return None
+
+def auto_connect():
+    """Find the console and connect to it, reporting progress to the UI"""
+    if not discovery_running.acquire(blocking=False):
+        return  # Already searching
+    try:
+        ports = [p['name'] for p in list_serial_ports()]
+        if connected and ser:
+            ports = [p for p in ports if p != ser.port]  # Already open, can't be sniffed
+        socketio.emit('status_update', {
+            'connected': connected,
+            'message': f'Searching {len(ports)} serial ports for a scoreboard...'
+        }, to=ROOM_SCOREBOARD)
+        found = discover_scoreboard_port(ports)
+        if found:
+            port, baud = found
+            socketio.emit('debug_data', {
+                'message': f'Scoreboard frames found on {port} at {baud} baud',
+                'type': 'success'
+            }, to=ROOM_DEBUG)
+            open_serial_port(port, baud)
+            socketio.emit('port_list', port_list_message())  # Selects the port in every open page
+        else:
+            socketio.emit('status_update', {
+                'connected': connected,
+                'message': 'No scoreboard found - check the cable or pick a port'
+            }, to=ROOM_SCOREBOARD)
+    finally:
+        discovery_running.release()
+
 def parse_scoreboard_data(data):
     """Parse the raw data from the scoreboard without hardcoding markers"""
     try:
@@ -457,22 +800,10 @@ def parse_scoreboard_data(data):
                 "away": str(int(away_score))
             }
         else:
-            # Log malformed data
-            log_message = f"Malformed data: '{data}' (cleaned: '{clean}') at {time.strftime('%Y-%m-%d %H:%M:%S')}\n"
-            with open("scoreboard_malformed.log", "a") as log_file:
-                log_file.write(log_message)
-            socketio.emit('debug_data', {
-                'message': f"Malformed data logged: {data}",
-                'type': 'warning'
-            })
+            # Logged and summarised on the debug page by the logging thread
+            malformed_log.record('Malformed frame', data, f"(cleaned: '{clean}')")
     except Exception as e:
-        log_message = f"Error parsing data: '{data}' | Exception: {str(e)} at {time.strftime('%Y-%m-%d %H:%M:%S')}\n"
-        with open("scoreboard_malformed.log", "a") as log_file:
-            log_file.write(log_message)
-        socketio.emit('debug_data', {
-            'message': f"Error parsing data and logged: {str(e)}",
-            'type': 'error'
-        })
+        malformed_log.record('Parse error', data, f'| Exception: {e}')
     return None
 
 def serial_reader():
@@ -483,7 +814,7 @@ def serial_reader():
     socketio.emit('debug_data', {
         'message': "Serial reader thread started",
         'type': 'info'
-    })
+    }, to=ROOM_DEBUG)
     buffer = ""
     while connected and ser:
         try:
@@ -506,16 +837,17 @@ def serial_reader():
                             if 'DEBUG_PRINT' in globals() and DEBUG_PRINT:
                                 print(f"[DEBUG] Emitting raw_data: {line}")
                             # Emit raw data
-                            socketio.emit('raw_data', {'data': line})
+                            stream_throttle.emit('raw_data', {'data': line}, ROOM_DEBUG)
                             # Try to parse
                             parsed = parse_scoreboard_data(line)
                             if parsed:
                                 last_data = parsed
-                                socketio.emit('scoreboard_data', parsed)
-                                socketio.emit('debug_data', {
+                                overlay_writer.update(parsed)
+                                socketio.emit('scoreboard_data', parsed, to=ROOM_SCOREBOARD)
+                                stream_throttle.emit('debug_data', {
                                     'message': f"Time: {parsed['time']}, Home: {parsed['home']}, Away: {parsed['away']}",
                                     'type': 'score'
-                                })
+                                }, ROOM_DEBUG)
             else:
                 # No data available, sleep briefly to avoid high CPU usage
                 time.sleep(0.1)
@@ -525,13 +857,15 @@ def serial_reader():
             socketio.emit('debug_data', {
                 'message': f"Serial read error: {str(e)}",
                 'type': 'error'
-            })
+            }, to=ROOM_DEBUG)
             time.sleep(1)  # Wait before retrying
 
 def main():
     """Main entry point"""
     parser = argparse.ArgumentParser(description='Scoreboard Web Interface')
     parser.add_argument('--port', type=str, help='Serial port to connect to')
+    parser.add_argument('--baud', type=int, default=9600, help='Baud rate for --port')
+    parser.add_argument('--no-auto', action='store_true', help='Do not search the serial ports for the scoreboard at launch')
     parser.add_argument('--host', type=str, default='0.0.0.0', help='Host to run the web server on')
     parser.add_argument('--web-port', type=int, default=5050, help='Port to run the web server on')
     parser.add_argument('--debug', action='store_true', help='Enable debug print output')
@@ -541,20 +875,18 @@ def main():
     DEBUG_PRINT = args.debug
     
     create_template_directory(force_rebuild=args.rebuild_templates)
+    overlay_writer.update(last_data)
+    overlay_writer.start()
+    malformed_log.start()
     
-    # Connect to serial port if specified
+    # Connect to serial port if specified, otherwise look for the console on every port
     if args.port:
-        global ser, connected
-        try:
-            ser = serial.Serial(args.port, baudrate=9600, timeout=1)
-            connected = True
-            if args.debug:
-                print(f"Connected to port {args.port}")
-            # Start reading thread
-            threading.Thread(target=serial_reader, daemon=True).start()
-        except Exception as e:
-            if args.debug:
-                print(f"Failed to connect to port {args.port}: {str(e)}")
+        if open_serial_port(args.port, args.baud) and args.debug:
+            print(f"Connected to port {args.port}")
+        elif args.debug:
+            print(f"Failed to connect to port {args.port}")
+    elif not args.no_auto:
+        threading.Thread(target=auto_connect, daemon=True).start()
     
     # Open web browser after a delay
     def open_browser():